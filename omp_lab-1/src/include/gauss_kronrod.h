@@ -0,0 +1,93 @@
+#pragma once
+#include <cmath>
+
+
+// Gauss-Kronrod rule on [-1, 1]. The abscissae are symmetric, so only the
+// non-negative half is stored in descending order, the last node is the centre.
+// Odd nodes of the Kronrod rule are the nodes of the embedded Gauss rule
+struct GaussKronrodRule {
+    int size;                   // number of stored Kronrod nodes (centre included)
+    int gauss_size;             // number of points of the embedded Gauss rule
+    const double *nodes;
+    const double *weights_kronrod;
+    const double *weights_gauss;
+};
+
+struct Panel {
+    double left, right;
+    double area, error;
+};
+
+
+// Values are taken from QUADPACK (qk15, qk21)
+constexpr double GK15_NODES[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000
+};
+constexpr double GK15_WEIGHTS_KRONROD[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+};
+constexpr double GK15_WEIGHTS_GAUSS[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+};
+
+constexpr double GK21_NODES[11] = {
+    0.995657163025808080735527280689003, 0.973906528517171720077964012084452,
+    0.930157491355708226001207180059508, 0.865063366688984510732096688423493,
+    0.780817726586416897063717578345042, 0.679409568299024406234327365114874,
+    0.562757134668604683339000099272694, 0.433395394129247190799265943165784,
+    0.294392862701460198131126603103866, 0.148874338981631210884826001129720,
+    0.000000000000000000000000000000000
+};
+constexpr double GK21_WEIGHTS_KRONROD[11] = {
+    0.011694638867371874278064396062192, 0.032558162307964727478818972459390,
+    0.054755896574351996031381300244580, 0.075039674810919952767043140916190,
+    0.093125454583697605535065465083366, 0.109387158802297641899210590325805,
+    0.123491976262065851077208980627124, 0.134709217311473325928054001771707,
+    0.142775938577060080797094273138717, 0.147739104901338491374841515972068,
+    0.149445554002916905664936468389821
+};
+constexpr double GK21_WEIGHTS_GAUSS[5] = {
+    0.066671344308688137593568809893332, 0.149451349150580593145776339657697,
+    0.219086362515982043995534934228163, 0.269266719309996355091226921569469,
+    0.295524224714752870173892994651146
+};
+
+constexpr GaussKronrodRule GK15 = {8, 7, GK15_NODES, GK15_WEIGHTS_KRONROD, GK15_WEIGHTS_GAUSS};
+constexpr GaussKronrodRule GK21 = {11, 10, GK21_NODES, GK21_WEIGHTS_KRONROD, GK21_WEIGHTS_GAUSS};
+
+
+// Number of integrand calls per panel
+constexpr int gauss_kronrod_points(const GaussKronrodRule &rule) {
+    return 2 * rule.size - 1;
+}
+
+
+// Integrates func over [panel.left, panel.right] by the Kronrod rule, the
+// difference with the embedded Gauss rule is taken as the error estimate
+template <class Func>
+void gauss_kronrod_panel(const Func &func, const GaussKronrodRule &rule, Panel &panel) {
+    double half = (panel.right - panel.left) / 2;
+    double centre = panel.left + half;
+    double f_centre = func(centre);
+    double kronrod = f_centre * rule.weights_kronrod[rule.size - 1];
+    double gauss = rule.gauss_size % 2 ? f_centre * rule.weights_gauss[rule.gauss_size / 2] : 0.0;
+
+    for (int j = 0; j < rule.size - 1; j++) {
+        double shift = half * rule.nodes[j];
+        double f_pair = func(centre - shift) + func(centre + shift);
+
+        kronrod += rule.weights_kronrod[j] * f_pair;
+        if (j % 2)
+            gauss += rule.weights_gauss[j / 2] * f_pair;
+    }
+
+    panel.area = kronrod * half;
+    panel.error = std::abs((kronrod - gauss) * half);
+}
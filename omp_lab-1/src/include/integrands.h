@@ -0,0 +1,53 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+#include "ln_sin.h"
+
+
+// Compiled-in integrands. Each one is a stateless functor, so the engines
+// instantiated for it inline the call, and provides a batch kernel for the
+// simd engine: a vectorized one if there is any, the plain loop otherwise
+
+
+template <class Func>
+void batch_apply(const double *x, double *y, std::size_t n) {
+    Func func;
+
+    for (std::size_t i = 0; i < n; i++)
+        y[i] = func(x[i]);
+}
+
+
+// ln(sin(x)), logarithmic singularities at k * pi
+struct LnSin {
+    double operator()(double x) const { return std::log(std::sin(x)); }
+    static batch_integrand_t batch() { return ln_sin_batch(); }
+};
+
+// Chebyshev polynomial T3(x) = 4x^3 - 3x
+struct Poly3 {
+    double operator()(double x) const { return (4 * x * x - 3) * x; }
+    static batch_integrand_t batch() { return batch_apply<Poly3>; }
+};
+
+// Chebyshev polynomial T8(x) = 128x^8 - 256x^6 + 160x^4 - 32x^2 + 1
+struct Poly8 {
+    double operator()(double x) const {
+        double x2 = x * x;
+        return (((128 * x2 - 256) * x2 + 160) * x2 - 32) * x2 + 1;
+    }
+    static batch_integrand_t batch() { return batch_apply<Poly8>; }
+};
+
+// e^x, smooth and growing
+struct Exp {
+    double operator()(double x) const { return std::exp(x); }
+    static batch_integrand_t batch() { return batch_apply<Exp>; }
+};
+
+// cos(50x), oscillatory: many sign changes cancel out in the area
+struct Oscillatory {
+    double operator()(double x) const { return std::cos(50 * x); }
+    static batch_integrand_t batch() { return batch_apply<Oscillatory>; }
+};
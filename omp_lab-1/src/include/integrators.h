@@ -0,0 +1,691 @@
+#pragma once
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <omp.h>
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+#include "omp_estimator.h"
+#include "gauss_kronrod.h"
+#include "ln_sin.h"
+
+
+// Integration engines, templated on the integrand functor so it is inlined
+// into the hot loops. Every engine has an OpenMP and a serial version
+
+
+// Number of integrand calls made by the last integral computed by this thread
+inline thread_local std::int64_t integrand_calls = 0;
+// Whether the last integral computed by this thread has reached its Epsilon
+// (the Romberg and Gauss-Kronrod engines may run out of refinement levels before that)
+inline thread_local bool integral_converged = true;
+
+
+// Romberg table is limited in depth, 3^20 panels are far beyond any sane epsilon
+constexpr int ROMBERG_MAX_LEVEL = 20;
+constexpr int ROMBERG_MAX_COLUMN = 8;
+// Gauss-Kronrod panels are bisected at most this many times
+constexpr int GAUSS_KRONROD_MAX_ROUND = 64;
+// Samples of a single thread are summed up in chunks of this size
+constexpr std::int64_t ACCUMULATION_CHUNK = 1 << 16;
+// Abscissae are passed to the batch integrand by this many at once
+constexpr std::int64_t BATCH_SIZE = 256;
+// Number of refinement levels computed at once by the speculative engine
+constexpr int SPECULATIVE_DEPTH = 2;
+// Adaptive subdivision spawns tasks for the upper levels of the recursion only
+constexpr int ADAPTIVE_TASK_DEPTH = 12;
+
+
+// Sums func over the midpoints of n panels of the given step, which are given to
+// the calling thread by the work-sharing loop (to be called by every thread of
+// a team, no barrier at the end). The thread adds its running sum to the total
+// each ACCUMULATION_CHUNK samples, so billions of small terms never get
+// accumulated into a single large one
+template <class Func>
+double midpoint_sum_thread(const Func &func, double left, double step, std::int64_t n) {
+    double area = 0.0;
+    double sum = 0.0;
+    std::int64_t count = 0;
+
+    #pragma omp for schedule(runtime) nowait
+    for (std::int64_t i = 0; i < n; i++) {
+        sum += func(left + step / 2 + i * step);
+
+        if (++count == ACCUMULATION_CHUNK) {
+            area += sum * step;
+            sum = 0.0;
+            count = 0;
+        }
+    }
+
+    return area + sum * step;
+}
+
+
+template <class Func>
+double midpoint_sum(const Func &func, double left, double step, std::int64_t n) {
+    double area = 0.0;
+
+    #pragma omp parallel reduction(+: area)
+    area += midpoint_sum_thread(func, left, step, n);
+
+    return area;
+}
+
+
+template <class Func>
+double midpoint_sum_no_omp(const Func &func, double left, double step, std::int64_t n) {
+    double area = 0.0;
+
+    for (std::int64_t chunk = 0; chunk < n; chunk += ACCUMULATION_CHUNK) {
+        std::int64_t chunk_end = std::min(chunk + ACCUMULATION_CHUNK, n);
+        double sum = 0.0;
+
+        for (std::int64_t i = chunk; i < chunk_end; i++) {
+            sum += func(left + step / 2 + i * step);
+        }
+        area += sum * step;
+    }
+
+    return area;
+}
+
+
+template <class Func>
+double get_integral(const Func &func, double left, double right, double err_val) {
+    double area = std::numeric_limits<double>::max();
+    double step = right - left;
+    double area_prev;
+    // Trip count of the pass is kept exactly instead of (right - left) / step
+    std::int64_t n = left != right ? 1 : 0;
+    std::int64_t calls = 0;
+    
+    omp_estimator::timer_begin();
+    do {
+        area_prev = area;
+        area = midpoint_sum(func, left, step, n);
+
+        calls += n;
+        n = n * 2;
+        step = step / 2;
+        
+    } while (std::abs(area - area_prev) / 3 >= err_val );
+    omp_estimator::timer_end();
+    
+    integrand_calls = calls;
+    return area;
+}
+
+
+template <class Func>
+double get_integral_persistent(const Func &func, double left, double right, double err_val) {
+    double area = std::numeric_limits<double>::max();
+    // Rotating accumulators: pass k sums into slot k % 3 while the slot of
+    // pass k - 1 is cleared after the barrier, so each pass needs one barrier
+    double partial[3] = {0.0, 0.0, 0.0};
+    std::int64_t calls = 0;
+
+    omp_estimator::timer_begin();
+    #pragma omp parallel
+    {
+        double area_local = std::numeric_limits<double>::max();
+        double step = right - left;
+        double area_prev;
+        int pass = 0;
+        std::int64_t n = left != right ? 1 : 0;
+
+        do {
+            area_prev = area_local;
+            double area_thread = midpoint_sum_thread(func, left, step, n);
+
+            #pragma omp atomic
+            partial[pass % 3] += area_thread;
+
+            #pragma omp barrier
+            area_local = partial[pass % 3];
+
+            // Every thread has read the previous pass by now, its slot is free
+            #pragma omp single nowait
+            partial[(pass + 2) % 3] = 0.0;
+
+            step = step / 2;
+            n = n * 2;
+            pass++;
+
+        } while (std::abs(area_local - area_prev) / 3 >= err_val );
+
+        #pragma omp single nowait
+        {
+            area = area_local;
+            calls = std::max<std::int64_t>(n - 1, 0);
+        }
+    }
+    omp_estimator::timer_end();
+
+    integrand_calls = calls;
+    return area;
+}
+
+
+// Levels k .. k + SPECULATIVE_DEPTH - 1 of the refinement are computed in one
+// parallel region, threads go on to the next level without waiting for the
+// others. Convergence is then checked level by level, exactly as the per-pass
+// loop does, and the levels past the converged one are discarded
+template <class Func>
+double get_integral_speculative(const Func &func, double left, double right, double err_val) {
+    double area = std::numeric_limits<double>::max();
+    double step = right - left;
+    double area_prev;
+    std::int64_t n = left != right ? 1 : 0;
+    std::int64_t calls = 0;
+    bool converged = false;
+
+    omp_estimator::timer_begin();
+    do {
+        double levels[SPECULATIVE_DEPTH] = {};
+
+        #pragma omp parallel reduction(+: levels[:SPECULATIVE_DEPTH])
+        for (int d = 0; d < SPECULATIVE_DEPTH; d++) {
+            levels[d] += midpoint_sum_thread(func, left, std::ldexp(step, -d), n << d);
+        }
+
+        for (int d = 0; d < SPECULATIVE_DEPTH && !converged; d++) {
+            area_prev = area;
+            area = levels[d];
+            converged = !(std::abs(area - area_prev) / 3 >= err_val);
+        }
+        calls += n * ((1 << SPECULATIVE_DEPTH) - 1);
+        n = n << SPECULATIVE_DEPTH;
+        step = std::ldexp(step, -SPECULATIVE_DEPTH);
+
+    } while (!converged);
+    omp_estimator::timer_end();
+
+    integrand_calls = calls;
+    return area;
+}
+
+
+template <class Func>
+double get_integral_no_omp(const Func &func, double left, double right, double err_val) {
+    double area = std::numeric_limits<double>::max();
+    double step = right - left;
+    double area_prev;
+    std::int64_t n = left != right ? 1 : 0;
+    std::int64_t calls = 0;
+    
+    omp_estimator::timer_begin();
+    do  {
+        area_prev = area;
+        area = midpoint_sum_no_omp(func, left, step, n);
+
+        calls += n;
+        n = n * 2;
+        step = step / 2;
+
+    } while (std::abs(area - area_prev) / 3 >= err_val );
+    omp_estimator::timer_end();
+    
+    integrand_calls = calls;
+    return area;
+}
+
+
+#ifdef USE_MPI
+// Every pass the panels are split into contiguous blocks, one per rank, and each
+// rank sums its block by its own OpenMP team. The partial areas are combined by
+// an allreduce, so all ranks get the same area and agree on the convergence
+template <class Func>
+double get_integral_mpi(const Func &func, double left, double right, double err_val) {
+    double area = std::numeric_limits<double>::max();
+    double step = right - left;
+    double area_prev;
+    std::int64_t n = left != right ? 1 : 0;
+    std::int64_t calls = 0;
+    int rank, size;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    omp_estimator::timer_begin();
+    do {
+        area_prev = area;
+        std::int64_t begin = n * rank / size;
+        std::int64_t end = n * (rank + 1) / size;
+        double area_rank = midpoint_sum(func, left + begin * step, step, end - begin);
+
+        MPI_Allreduce(&area_rank, &area, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+        calls += n;
+        n = n * 2;
+        step = step / 2;
+
+    } while (std::abs(area - area_prev) / 3 >= err_val );
+    omp_estimator::timer_end();
+
+    integrand_calls = calls;
+    return area;
+}
+
+
+template <class Func>
+double get_integral_mpi_no_omp(const Func &func, double left, double right, double err_val) {
+    double area = std::numeric_limits<double>::max();
+    double step = right - left;
+    double area_prev;
+    std::int64_t n = left != right ? 1 : 0;
+    std::int64_t calls = 0;
+    int rank, size;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    omp_estimator::timer_begin();
+    do {
+        area_prev = area;
+        std::int64_t begin = n * rank / size;
+        std::int64_t end = n * (rank + 1) / size;
+        double area_rank = midpoint_sum_no_omp(func, left + begin * step, step, end - begin);
+
+        MPI_Allreduce(&area_rank, &area, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+        calls += n;
+        n = n * 2;
+        step = step / 2;
+
+    } while (std::abs(area - area_prev) / 3 >= err_val );
+    omp_estimator::timer_end();
+
+    integrand_calls = calls;
+    return area;
+}
+#endif
+
+
+// Appends a new midpoint estimate to the Romberg table and returns its diagonal.
+// Column j cancels the h^j error term: both the smooth h^2, h^4, ... terms and
+// the odd ones produced by logarithmic singularities at the interval ends
+inline double romberg_extrapolate(std::vector<double> &row, const std::vector<double> &row_prev, double midpoint) {
+    row.assign(1, midpoint);
+    double factor = 1.0;
+
+    for (std::size_t j = 1; j < row_prev.size() + 1 && j <= ROMBERG_MAX_COLUMN; j++) {
+        factor *= 3;
+        row.push_back(row[j - 1] + (row[j - 1] - row_prev[j - 1]) / (factor - 1));
+    }
+
+    return row.back();
+}
+
+
+template <class Func>
+double get_integral_romberg(const Func &func, double left, double right, double err_val) {
+    std::vector<double> row, row_prev;
+    double step = right - left;
+    double area, area_prev;
+    std::int64_t n = 1;
+    int level = 0;
+
+    omp_estimator::timer_begin();
+    // The samples of a zero-width interval may be infinite (a singular point), it has no area
+    if (left == right) {
+        omp_estimator::timer_end();
+        integrand_calls = 0;
+        return 0.0;
+    }
+
+    area = romberg_extrapolate(row, row_prev, func(left + step / 2) * step);
+    do {
+        area_prev = area;
+        row_prev.swap(row);
+        double sum = 0.0;
+
+        // Tripling the panels keeps the old midpoints, only 2 new samples per panel
+        #pragma omp parallel for reduction(+: sum) schedule(runtime)
+        for (std::int64_t i = 0; i < n; i++) {
+            sum += func(left + step / 6 + i * step) + func(left + step * 5 / 6 + i * step);
+        }
+        step = step / 3;
+        n = n * 3;
+        level++;
+
+        area = romberg_extrapolate(row, row_prev, row_prev[0] / 3 + sum * step);
+
+    } while ((level < 2 || std::abs(area - area_prev) / 3 >= err_val) && level < ROMBERG_MAX_LEVEL);
+    omp_estimator::timer_end();
+
+    // The table may be exhausted while the Runge's estimate still exceeds
+    // Epsilon, the last diagonal is returned anyway
+    integral_converged = !(std::abs(area - area_prev) / 3 >= err_val);
+    integrand_calls = n;
+    return area;
+}
+
+
+template <class Func>
+double get_integral_romberg_no_omp(const Func &func, double left, double right, double err_val) {
+    std::vector<double> row, row_prev;
+    double step = right - left;
+    double area, area_prev;
+    std::int64_t n = 1;
+    int level = 0;
+
+    omp_estimator::timer_begin();
+    // The samples of a zero-width interval may be infinite (a singular point), it has no area
+    if (left == right) {
+        omp_estimator::timer_end();
+        integrand_calls = 0;
+        return 0.0;
+    }
+
+    area = romberg_extrapolate(row, row_prev, func(left + step / 2) * step);
+    do {
+        area_prev = area;
+        row_prev.swap(row);
+        double sum = 0.0;
+
+        for (std::int64_t i = 0; i < n; i++) {
+            sum += func(left + step / 6 + i * step) + func(left + step * 5 / 6 + i * step);
+        }
+        step = step / 3;
+        n = n * 3;
+        level++;
+
+        area = romberg_extrapolate(row, row_prev, row_prev[0] / 3 + sum * step);
+
+    } while ((level < 2 || std::abs(area - area_prev) / 3 >= err_val) && level < ROMBERG_MAX_LEVEL);
+    omp_estimator::timer_end();
+
+    // The table may be exhausted while the Runge's estimate still exceeds
+    // Epsilon, the last diagonal is returned anyway
+    integral_converged = !(std::abs(area - area_prev) / 3 >= err_val);
+    integrand_calls = n;
+    return area;
+}
+
+
+struct Quadrature {
+    double area;
+    std::int64_t calls;
+};
+
+
+// Panel is split in halves only while its Runge error estimate exceeds its share
+// of err_val. Panels narrower than err_val are accepted as they are, since
+// the error of a panel touching a logarithmic singularity is proportional
+// to its width and never gets below the proportional share
+template <class Func>
+Quadrature adaptive_panel(const Func &func, double left, double right, double coarse,
+                          double tol, double min_step, int depth) {
+    double step = right - left;
+    double f_left = func(left + step / 4);
+    double f_right = func(left + step * 3 / 4);
+    double fine = (f_left + f_right) * step / 2;
+
+    if (std::abs(fine - coarse) / 3 >= tol && std::abs(step) >= min_step) {
+        Quadrature lhs, rhs;
+
+        // Deep panels are too cheap to be worth a separate task
+        #pragma omp task shared(lhs) final(depth >= ADAPTIVE_TASK_DEPTH) mergeable
+        lhs = adaptive_panel(func, left, left + step / 2, f_left * step / 2, tol / 2, min_step, depth + 1);
+        rhs = adaptive_panel(func, left + step / 2, right, f_right * step / 2, tol / 2, min_step, depth + 1);
+        #pragma omp taskwait
+
+        return {lhs.area + rhs.area, lhs.calls + rhs.calls + 2};
+    }
+
+    return {fine + (fine - coarse) / 3, 2};
+}
+
+
+template <class Func>
+Quadrature adaptive_panel_no_omp(const Func &func, double left, double right, double coarse,
+                                 double tol, double min_step) {
+    double step = right - left;
+    double f_left = func(left + step / 4);
+    double f_right = func(left + step * 3 / 4);
+    double fine = (f_left + f_right) * step / 2;
+
+    if (std::abs(fine - coarse) / 3 >= tol && std::abs(step) >= min_step) {
+        Quadrature lhs = adaptive_panel_no_omp(func, left, left + step / 2, f_left * step / 2, tol / 2, min_step);
+        Quadrature rhs = adaptive_panel_no_omp(func, left + step / 2, right, f_right * step / 2, tol / 2, min_step);
+
+        return {lhs.area + rhs.area, lhs.calls + rhs.calls + 2};
+    }
+
+    return {fine + (fine - coarse) / 3, 2};
+}
+
+
+template <class Func>
+double get_integral_adaptive(const Func &func, double left, double right, double err_val) {
+    Quadrature result;
+
+    omp_estimator::timer_begin();
+    // The samples of a zero-width interval may be infinite (a singular point), it has no area
+    if (left == right) {
+        omp_estimator::timer_end();
+        integrand_calls = 0;
+        return 0.0;
+    }
+
+    double coarse = func(left + (right - left) / 2) * (right - left);
+
+    #pragma omp parallel
+    #pragma omp single
+    result = adaptive_panel(func, left, right, coarse, err_val, err_val, 0);
+    omp_estimator::timer_end();
+
+    integrand_calls = result.calls + 1;
+    return result.area;
+}
+
+
+template <class Func>
+double get_integral_adaptive_no_omp(const Func &func, double left, double right, double err_val) {
+    Quadrature result;
+
+    omp_estimator::timer_begin();
+    // The samples of a zero-width interval may be infinite (a singular point), it has no area
+    if (left == right) {
+        omp_estimator::timer_end();
+        integrand_calls = 0;
+        return 0.0;
+    }
+
+    double coarse = func(left + (right - left) / 2) * (right - left);
+    result = adaptive_panel_no_omp(func, left, right, coarse, err_val, err_val);
+    omp_estimator::timer_end();
+
+    integrand_calls = result.calls + 1;
+    return result.area;
+}
+
+
+// Accepts the panels within their share of err_val and splits the others in halves
+inline void gauss_kronrod_split(std::vector<Panel> &pending, std::vector<Panel> &next,
+                         double &area_done, double &error_done, double share) {
+    next.clear();
+
+    for (auto &panel: pending) {
+        if (panel.error > share * (panel.right - panel.left)) {
+            double middle = panel.left + (panel.right - panel.left) / 2;
+            next.push_back({panel.left, middle, 0.0, 0.0});
+            next.push_back({middle, panel.right, 0.0, 0.0});
+        } else {
+            area_done += panel.area;
+            error_done += panel.error;
+        }
+    }
+
+    pending.swap(next);
+}
+
+
+// Each round evaluates the pending panels in parallel and stops as soon as the
+// total error estimate gets below err_val. If it does not, at least one panel
+// exceeds its share of err_val (proportional to its length) and gets split
+template <const GaussKronrodRule &rule, class Func>
+double get_integral_gauss_kronrod(const Func &func, double left, double right, double err_val) {
+    std::vector<Panel> pending = {{left, right, 0.0, 0.0}}, next;
+    double area_done = 0.0, error_done = 0.0;
+    double area, error;
+    std::int64_t panels = 0;
+    int round = 0;
+
+    omp_estimator::timer_begin();
+    // The samples of a zero-width interval may be infinite (a singular point), it has no area
+    if (left == right) {
+        omp_estimator::timer_end();
+        integrand_calls = 0;
+        return 0.0;
+    }
+
+    do {
+        area = area_done;
+        error = error_done;
+
+        #pragma omp parallel for reduction(+: area, error) schedule(runtime)
+        for (std::size_t i = 0; i < pending.size(); i++) {
+            gauss_kronrod_panel(func, rule, pending[i]);
+            area += pending[i].area;
+            error += pending[i].error;
+        }
+        panels += pending.size();
+        round++;
+
+        if (error >= err_val)
+            gauss_kronrod_split(pending, next, area_done, error_done, err_val / (right - left));
+
+    } while (error >= err_val && !pending.empty() && round < GAUSS_KRONROD_MAX_ROUND);
+    omp_estimator::timer_end();
+
+    // The rounds may run out while the error estimate still exceeds Epsilon
+    integral_converged = !(error >= err_val);
+    integrand_calls = panels * gauss_kronrod_points(rule);
+    return area;
+}
+
+
+template <const GaussKronrodRule &rule, class Func>
+double get_integral_gauss_kronrod_no_omp(const Func &func, double left, double right, double err_val) {
+    std::vector<Panel> pending = {{left, right, 0.0, 0.0}}, next;
+    double area_done = 0.0, error_done = 0.0;
+    double area, error;
+    std::int64_t panels = 0;
+    int round = 0;
+
+    omp_estimator::timer_begin();
+    // The samples of a zero-width interval may be infinite (a singular point), it has no area
+    if (left == right) {
+        omp_estimator::timer_end();
+        integrand_calls = 0;
+        return 0.0;
+    }
+
+    do {
+        area = area_done;
+        error = error_done;
+
+        for (std::size_t i = 0; i < pending.size(); i++) {
+            gauss_kronrod_panel(func, rule, pending[i]);
+            area += pending[i].area;
+            error += pending[i].error;
+        }
+        panels += pending.size();
+        round++;
+
+        if (error >= err_val)
+            gauss_kronrod_split(pending, next, area_done, error_done, err_val / (right - left));
+
+    } while (error >= err_val && !pending.empty() && round < GAUSS_KRONROD_MAX_ROUND);
+    omp_estimator::timer_end();
+
+    // The rounds may run out while the error estimate still exceeds Epsilon
+    integral_converged = !(error >= err_val);
+    integrand_calls = panels * gauss_kronrod_points(rule);
+    return area;
+}
+
+
+// Sums func(left + step / 2 + i * step) over i in [begin, begin + count), count <= BATCH_SIZE
+inline double batch_sum(batch_integrand_t batch, double left, double step, std::int64_t begin, std::size_t count) {
+    double x[BATCH_SIZE], y[BATCH_SIZE];
+    double sum = 0.0;
+
+    // The whole buffer is filled, the tail of the last batch is simply not evaluated
+    for (std::int64_t i = 0; i < BATCH_SIZE; i++)
+        x[i] = left + step / 2 + (begin + i) * step;
+
+    batch(x, y, count);
+
+    for (std::size_t i = 0; i < count; i++)
+        sum += y[i];
+
+    return sum;
+}
+
+
+// Centered rectangles with the samples evaluated by the batch kernel of the
+// integrand (vectorized for ln(sin(x))), the functor itself is not called
+template <class Func>
+double get_integral_simd(const Func &, double left, double right, double err_val) {
+    double area = std::numeric_limits<double>::max();
+    double step = right - left;
+    double area_prev;
+    std::int64_t n = left != right ? 1 : 0;
+    std::int64_t calls = 0;
+    batch_integrand_t batch = Func::batch();
+
+    omp_estimator::timer_begin();
+    do {
+        area_prev = area;
+        area = 0.0;
+
+        #pragma omp parallel for reduction(+: area) schedule(runtime)
+        for (std::int64_t i = 0; i < n; i += BATCH_SIZE) {
+            area += batch_sum(batch, left, step, i, std::min(BATCH_SIZE, n - i)) * step;
+        }
+        calls += n;
+        n = n * 2;
+        step = step / 2;
+
+    } while (std::abs(area - area_prev) / 3 >= err_val );
+    omp_estimator::timer_end();
+
+    integrand_calls = calls;
+    return area;
+}
+
+
+template <class Func>
+double get_integral_simd_no_omp(const Func &, double left, double right, double err_val) {
+    double area = std::numeric_limits<double>::max();
+    double step = right - left;
+    double area_prev;
+    std::int64_t n = left != right ? 1 : 0;
+    std::int64_t calls = 0;
+    batch_integrand_t batch = Func::batch();
+
+    omp_estimator::timer_begin();
+    do {
+        area_prev = area;
+        area = 0.0;
+
+        for (std::int64_t i = 0; i < n; i += BATCH_SIZE) {
+            area += batch_sum(batch, left, step, i, std::min(BATCH_SIZE, n - i)) * step;
+        }
+        calls += n;
+        n = n * 2;
+        step = step / 2;
+
+    } while (std::abs(area - area_prev) / 3 >= err_val );
+    omp_estimator::timer_end();
+
+    integrand_calls = calls;
+    return area;
+}
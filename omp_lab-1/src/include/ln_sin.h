@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+
+
+// Batch integrand: evaluates y[i] = f(x[i]) for the whole array at once
+typedef void (*batch_integrand_t)(const double *x, double *y, std::size_t n);
+
+// Largest deviation of a vectorized kernel from std::log(std::sin(x)), in ULPs
+// of max(|y|, 1). Near x = pi / 2 the result approaches zero, and any error of
+// sin(x) is carried by the logarithm as an absolute one, so the bound is not
+// relative there (the scalar expression itself loses precision the same way)
+constexpr double LN_SIN_MAX_ULP = 2.0;
+
+
+void ln_sin_batch_scalar(const double *x, double *y, std::size_t n);
+void ln_sin_batch_avx2(const double *x, double *y, std::size_t n);
+void ln_sin_batch_avx512(const double *x, double *y, std::size_t n);
+
+// Deviation of the kernel from the scalar ln(sin(x)) on a fixed set of abscissae
+double ln_sin_max_ulp(batch_integrand_t kernel);
+
+// Kernel chosen by the CPU features at the first call. $LN_SIN_KERNEL may
+// force one of "scalar", "avx2" or "avx512". A kernel, which does not meet
+// LN_SIN_MAX_ULP, is replaced by the scalar one
+batch_integrand_t ln_sin_batch();
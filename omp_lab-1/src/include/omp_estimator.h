@@ -3,6 +3,7 @@
 #include <memory>
 #include <functional>
 #include <any>
+#include <type_traits>
 
 namespace omp_estimator {
     
@@ -13,17 +14,19 @@ namespace omp_estimator {
         double avg_duration = -1;
         std::any return_value;
 
-        static std::chrono::_V2::steady_clock::time_point begin;
-        static std::chrono::_V2::steady_clock::time_point end;
+        // Engines may run concurrently (batch mode), each thread keeps its own marks
+        static thread_local std::chrono::_V2::steady_clock::time_point begin;
+        static thread_local std::chrono::_V2::steady_clock::time_point end;
     public:
         PerformanceEstimator(int iterations = 100): num_iterations(iterations) {};
         
-        template <class T, class... Args>
-        void estimate(T (*callable)(Args...), Args... args);
+        // Accepts any callable: a functor or a lambda is called directly
+        // rather than through a function pointer
+        template <class Callable, class... Args>
+        void estimate(Callable &&callable, Args... args);
         
-        template <class T>
-        void set_return_value(std::function<T()> &callable);
-        void set_return_value(std::function<void()> &callable) { return; };
+        template <class Callable>
+        void set_return_value(Callable &callable);
 
         double get_elapsed_time();
         std::any get_return_value();
@@ -33,12 +36,12 @@ namespace omp_estimator {
     };
 
 
-    template <class T, class... Args>
-    void PerformanceEstimator::estimate(T (*callable)(Args...), Args... args) {
+    template <class Callable, class... Args>
+    void PerformanceEstimator::estimate(Callable &&callable, Args... args) {
         int64_t execution_time = 0;
         
         // Standardizing callable
-        std::function<T()> func = std::bind(callable, std::forward<Args>(args)...);
+        auto func = [&]() { return callable(args...); };
         set_return_value(func);
         
         // Warming up
@@ -57,9 +60,12 @@ namespace omp_estimator {
     };
     
     
-    template <class T>
-    void PerformanceEstimator::set_return_value(std::function<T()> &callable) {
-        this->return_value = callable();
+    template <class Callable>
+    void PerformanceEstimator::set_return_value(Callable &callable) {
+        if constexpr (std::is_void_v<decltype(callable())>)
+            callable();
+        else
+            this->return_value = callable();
     };
 
 
@@ -0,0 +1,306 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include <immintrin.h>
+
+#include "ln_sin.h"
+
+
+namespace {
+
+    // pi / 2 split in two doubles, the products with k are subtracted by FMA
+    constexpr double PIO2_HI = 1.57079632679489655800e+00;
+    constexpr double PIO2_LO = 6.12323399573676603587e-17;
+    constexpr double TWO_OVER_PI = 6.36619772367581382433e-01;
+    // Beyond this the two-term reduction loses precision, lanes go to the scalar path
+    constexpr double REDUCTION_LIMIT = 1e5;
+    // Adding it to an integral double leaves the integer in the low mantissa bits
+    constexpr double ROUND_MAGIC = 6755399441055744.0;      // 1.5 * 2^52
+
+    // fdlibm __kernel_sin and __kernel_cos minimax coefficients on [-pi/4, pi/4]
+    constexpr double S1 = -1.66666666666666324348e-01;
+    constexpr double S2 =  8.33333333332248946124e-03;
+    constexpr double S3 = -1.98412698298579493134e-04;
+    constexpr double S4 =  2.75573137070700676789e-06;
+    constexpr double S5 = -2.50507602534068634195e-08;
+    constexpr double S6 =  1.58969099521155010221e-10;
+
+    constexpr double C1 =  4.16666666666666019037e-02;
+    constexpr double C2 = -1.38888888888741095749e-03;
+    constexpr double C3 =  2.48015872894767294178e-05;
+    constexpr double C4 = -2.75573143513906633035e-07;
+    constexpr double C5 =  2.08757232129817482790e-09;
+    constexpr double C6 = -1.13596475577881948265e-11;
+
+    // fdlibm __ieee754_log coefficients for log(1 + f) = f - f^2 / 2 + s * (f^2 / 2 + R)
+    constexpr double LG1 = 6.666666666666735130e-01;
+    constexpr double LG2 = 3.999999999940941908e-01;
+    constexpr double LG3 = 2.857142874366239149e-01;
+    constexpr double LG4 = 2.222219843214978396e-01;
+    constexpr double LG5 = 1.818357216161805012e-01;
+    constexpr double LG6 = 1.531383769920937332e-01;
+    constexpr double LG7 = 1.479819860511658591e-01;
+    constexpr double LN2_HI = 6.93147180369123816490e-01;
+    constexpr double LN2_LO = 1.90821492927058770002e-10;
+    constexpr double SQRT2 = 1.41421356237309514547e+00;
+
+    constexpr double TWO_52 = 4503599627370496.0;
+    constexpr double DBL_NORM_MIN = 2.2250738585072014e-308;
+    constexpr std::int64_t MANTISSA_MASK = 0x000FFFFFFFFFFFFF;
+    constexpr std::int64_t ONE_BITS = 0x3FF0000000000000;
+    constexpr std::int64_t SIGN_BITS = static_cast<std::int64_t>(0x8000000000000000);
+
+
+    void ln_sin_lanes(const double *x, double *y, std::size_t n) {
+        for (std::size_t i = 0; i < n; i++)
+            y[i] = std::log(std::sin(x[i]));
+    }
+
+
+    __attribute__((target("avx2,fma")))
+    void ln_sin_avx2(const double *x, double *y) {
+        __m256d v = _mm256_loadu_pd(x);
+
+        // x = k * pi / 2 + r, |r| <= pi / 4, the low bits of k_magic hold the quadrant
+        __m256d k_magic = _mm256_fmadd_pd(v, _mm256_set1_pd(TWO_OVER_PI), _mm256_set1_pd(ROUND_MAGIC));
+        __m256d k = _mm256_sub_pd(k_magic, _mm256_set1_pd(ROUND_MAGIC));
+        __m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(PIO2_HI), v);
+        r = _mm256_fnmadd_pd(k, _mm256_set1_pd(PIO2_LO), r);
+        __m256i quadrant = _mm256_castpd_si256(k_magic);
+
+        __m256d z = _mm256_mul_pd(r, r);
+        __m256d ps = _mm256_fmadd_pd(_mm256_set1_pd(S6), z, _mm256_set1_pd(S5));
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S4));
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S3));
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S2));
+        ps = _mm256_fmadd_pd(ps, z, _mm256_set1_pd(S1));
+        __m256d sin_r = _mm256_fmadd_pd(_mm256_mul_pd(r, z), ps, r);
+
+        __m256d pc = _mm256_fmadd_pd(_mm256_set1_pd(C6), z, _mm256_set1_pd(C5));
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C4));
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C3));
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C2));
+        pc = _mm256_fmadd_pd(pc, z, _mm256_set1_pd(C1));
+        __m256d cos_r = _mm256_fmadd_pd(_mm256_mul_pd(z, z), pc,
+                                        _mm256_fnmadd_pd(_mm256_set1_pd(0.5), z, _mm256_set1_pd(1.0)));
+
+        // Odd quadrants take cosine, quadrants 2 and 3 flip the sign
+        __m256i odd = _mm256_cmpeq_epi64(_mm256_and_si256(quadrant, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(1));
+        __m256d sin_v = _mm256_blendv_pd(sin_r, cos_r, _mm256_castsi256_pd(odd));
+        __m256i sign = _mm256_slli_epi64(_mm256_and_si256(quadrant, _mm256_set1_epi64x(2)), 62);
+        sin_v = _mm256_xor_pd(sin_v, _mm256_castsi256_pd(sign));
+
+        // Non-positive, subnormal or NaN sine and huge abscissae are left to libm
+        __m256d abs_v = _mm256_andnot_pd(_mm256_castsi256_pd(_mm256_set1_epi64x(SIGN_BITS)), v);
+        __m256d fast = _mm256_and_pd(_mm256_cmp_pd(sin_v, _mm256_set1_pd(DBL_NORM_MIN), _CMP_GE_OQ),
+                                     _mm256_cmp_pd(abs_v, _mm256_set1_pd(REDUCTION_LIMIT), _CMP_LE_OQ));
+        if (_mm256_movemask_pd(fast) != 0xF) {
+            ln_sin_lanes(x, y, 4);
+            return;
+        }
+
+        // sin = 2^e * m, sqrt(2) / 2 < m <= sqrt(2)
+        __m256i bits = _mm256_castpd_si256(sin_v);
+        __m256d e = _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52),
+                                                        _mm256_castpd_si256(_mm256_set1_pd(TWO_52))));
+        e = _mm256_sub_pd(e, _mm256_set1_pd(TWO_52 + 1023));
+        __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(MANTISSA_MASK)),
+                                                        _mm256_set1_epi64x(ONE_BITS)));
+        __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(SQRT2), _CMP_GT_OQ);
+        m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+        e = _mm256_add_pd(e, _mm256_and_pd(big, _mm256_set1_pd(1.0)));
+
+        __m256d f = _mm256_sub_pd(m, _mm256_set1_pd(1.0));
+        __m256d s = _mm256_div_pd(f, _mm256_add_pd(f, _mm256_set1_pd(2.0)));
+        __m256d zs = _mm256_mul_pd(s, s);
+        __m256d w = _mm256_mul_pd(zs, zs);
+        __m256d t1 = _mm256_fmadd_pd(_mm256_set1_pd(LG6), w, _mm256_set1_pd(LG4));
+        t1 = _mm256_mul_pd(w, _mm256_fmadd_pd(t1, w, _mm256_set1_pd(LG2)));
+        __m256d t2 = _mm256_fmadd_pd(_mm256_set1_pd(LG7), w, _mm256_set1_pd(LG5));
+        t2 = _mm256_fmadd_pd(t2, w, _mm256_set1_pd(LG3));
+        t2 = _mm256_mul_pd(zs, _mm256_fmadd_pd(t2, w, _mm256_set1_pd(LG1)));
+        __m256d big_r = _mm256_add_pd(t1, t2);
+        __m256d hfsq = _mm256_mul_pd(_mm256_set1_pd(0.5), _mm256_mul_pd(f, f));
+
+        // e * ln2_hi - ((hfsq - (s * (hfsq + R) + e * ln2_lo)) - f)
+        __m256d inner = _mm256_fmadd_pd(e, _mm256_set1_pd(LN2_LO), _mm256_mul_pd(s, _mm256_add_pd(hfsq, big_r)));
+        __m256d result = _mm256_sub_pd(_mm256_sub_pd(hfsq, inner), f);
+        result = _mm256_sub_pd(_mm256_mul_pd(e, _mm256_set1_pd(LN2_HI)), result);
+
+        _mm256_storeu_pd(y, result);
+    }
+
+
+    __attribute__((target("avx512f")))
+    void ln_sin_avx512(const double *x, double *y) {
+        __m512d v = _mm512_loadu_pd(x);
+
+        // x = k * pi / 2 + r, |r| <= pi / 4, the low bits of k_magic hold the quadrant
+        __m512d k_magic = _mm512_fmadd_pd(v, _mm512_set1_pd(TWO_OVER_PI), _mm512_set1_pd(ROUND_MAGIC));
+        __m512d k = _mm512_sub_pd(k_magic, _mm512_set1_pd(ROUND_MAGIC));
+        __m512d r = _mm512_fnmadd_pd(k, _mm512_set1_pd(PIO2_HI), v);
+        r = _mm512_fnmadd_pd(k, _mm512_set1_pd(PIO2_LO), r);
+        __m512i quadrant = _mm512_castpd_si512(k_magic);
+
+        __m512d z = _mm512_mul_pd(r, r);
+        __m512d ps = _mm512_fmadd_pd(_mm512_set1_pd(S6), z, _mm512_set1_pd(S5));
+        ps = _mm512_fmadd_pd(ps, z, _mm512_set1_pd(S4));
+        ps = _mm512_fmadd_pd(ps, z, _mm512_set1_pd(S3));
+        ps = _mm512_fmadd_pd(ps, z, _mm512_set1_pd(S2));
+        ps = _mm512_fmadd_pd(ps, z, _mm512_set1_pd(S1));
+        __m512d sin_r = _mm512_fmadd_pd(_mm512_mul_pd(r, z), ps, r);
+
+        __m512d pc = _mm512_fmadd_pd(_mm512_set1_pd(C6), z, _mm512_set1_pd(C5));
+        pc = _mm512_fmadd_pd(pc, z, _mm512_set1_pd(C4));
+        pc = _mm512_fmadd_pd(pc, z, _mm512_set1_pd(C3));
+        pc = _mm512_fmadd_pd(pc, z, _mm512_set1_pd(C2));
+        pc = _mm512_fmadd_pd(pc, z, _mm512_set1_pd(C1));
+        __m512d cos_r = _mm512_fmadd_pd(_mm512_mul_pd(z, z), pc,
+                                        _mm512_fnmadd_pd(_mm512_set1_pd(0.5), z, _mm512_set1_pd(1.0)));
+
+        // Odd quadrants take cosine, quadrants 2 and 3 flip the sign
+        __mmask8 odd = _mm512_test_epi64_mask(quadrant, _mm512_set1_epi64(1));
+        __m512d sin_v = _mm512_mask_blend_pd(odd, sin_r, cos_r);
+        __mmask8 negative = _mm512_test_epi64_mask(quadrant, _mm512_set1_epi64(2));
+        sin_v = _mm512_castsi512_pd(_mm512_mask_xor_epi64(_mm512_castpd_si512(sin_v), negative,
+                                                          _mm512_castpd_si512(sin_v), _mm512_set1_epi64(SIGN_BITS)));
+
+        // Non-positive, subnormal or NaN sine and huge abscissae are left to libm
+        __mmask8 fast = _mm512_cmp_pd_mask(sin_v, _mm512_set1_pd(DBL_NORM_MIN), _CMP_GE_OQ)
+                      & _mm512_cmp_pd_mask(_mm512_abs_pd(v), _mm512_set1_pd(REDUCTION_LIMIT), _CMP_LE_OQ);
+        if (fast != 0xFF) {
+            ln_sin_lanes(x, y, 8);
+            return;
+        }
+
+        // sin = 2^e * m, sqrt(2) / 2 < m <= sqrt(2). Zero-masked shift keeps GCC
+        // from warning about the undefined source of the unmasked intrinsic
+        __m512i bits = _mm512_castpd_si512(sin_v);
+        __m512d e = _mm512_castsi512_pd(_mm512_or_si512(_mm512_maskz_srli_epi64(0xFF, bits, 52),
+                                                        _mm512_castpd_si512(_mm512_set1_pd(TWO_52))));
+        e = _mm512_sub_pd(e, _mm512_set1_pd(TWO_52 + 1023));
+        __m512d m = _mm512_castsi512_pd(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi64(MANTISSA_MASK)),
+                                                        _mm512_set1_epi64(ONE_BITS)));
+        __mmask8 big = _mm512_cmp_pd_mask(m, _mm512_set1_pd(SQRT2), _CMP_GT_OQ);
+        m = _mm512_mask_mul_pd(m, big, m, _mm512_set1_pd(0.5));
+        e = _mm512_mask_add_pd(e, big, e, _mm512_set1_pd(1.0));
+
+        __m512d f = _mm512_sub_pd(m, _mm512_set1_pd(1.0));
+        __m512d s = _mm512_div_pd(f, _mm512_add_pd(f, _mm512_set1_pd(2.0)));
+        __m512d zs = _mm512_mul_pd(s, s);
+        __m512d w = _mm512_mul_pd(zs, zs);
+        __m512d t1 = _mm512_fmadd_pd(_mm512_set1_pd(LG6), w, _mm512_set1_pd(LG4));
+        t1 = _mm512_mul_pd(w, _mm512_fmadd_pd(t1, w, _mm512_set1_pd(LG2)));
+        __m512d t2 = _mm512_fmadd_pd(_mm512_set1_pd(LG7), w, _mm512_set1_pd(LG5));
+        t2 = _mm512_fmadd_pd(t2, w, _mm512_set1_pd(LG3));
+        t2 = _mm512_mul_pd(zs, _mm512_fmadd_pd(t2, w, _mm512_set1_pd(LG1)));
+        __m512d big_r = _mm512_add_pd(t1, t2);
+        __m512d hfsq = _mm512_mul_pd(_mm512_set1_pd(0.5), _mm512_mul_pd(f, f));
+
+        // e * ln2_hi - ((hfsq - (s * (hfsq + R) + e * ln2_lo)) - f)
+        __m512d inner = _mm512_fmadd_pd(e, _mm512_set1_pd(LN2_LO), _mm512_mul_pd(s, _mm512_add_pd(hfsq, big_r)));
+        __m512d result = _mm512_sub_pd(_mm512_sub_pd(hfsq, inner), f);
+        result = _mm512_sub_pd(_mm512_mul_pd(e, _mm512_set1_pd(LN2_HI)), result);
+
+        _mm512_storeu_pd(y, result);
+    }
+
+
+    double ulp_distance(double expected, double actual) {
+        if (std::isnan(expected) || std::isnan(actual))
+            return std::isnan(expected) && std::isnan(actual) ? 0.0 : INFINITY;
+        if (expected == actual)
+            return 0.0;
+
+        double scale = std::max(std::abs(expected), 1.0);
+        return std::abs(expected - actual) / (std::nextafter(scale, INFINITY) - scale);
+    }
+
+
+    batch_integrand_t select_kernel() {
+        const char *forced = std::getenv("LN_SIN_KERNEL");
+        std::string_view name = forced ? forced : "";
+
+        if (name == "scalar")
+            return ln_sin_batch_scalar;
+        if ((name.empty() || name == "avx512") && __builtin_cpu_supports("avx512f"))
+            return ln_sin_batch_avx512;
+        if ((name.empty() || name == "avx2") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return ln_sin_batch_avx2;
+
+        return ln_sin_batch_scalar;
+    }
+
+}   // end of anonymous namespace
+
+
+void ln_sin_batch_scalar(const double *x, double *y, std::size_t n) {
+    ln_sin_lanes(x, y, n);
+}
+
+
+void ln_sin_batch_avx2(const double *x, double *y, std::size_t n) {
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        ln_sin_avx2(x + i, y + i);
+
+    ln_sin_lanes(x + i, y + i, n - i);
+}
+
+
+void ln_sin_batch_avx512(const double *x, double *y, std::size_t n) {
+    std::size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        ln_sin_avx512(x + i, y + i);
+
+    ln_sin_lanes(x + i, y + i, n - i);
+}
+
+
+double ln_sin_max_ulp(batch_integrand_t kernel) {
+    constexpr int GRID = 1 << 14;
+    std::vector<double> x, expected, actual;
+
+    // Uniform grid over several periods plus the points approaching 0 and pi
+    for (int i = 0; i < GRID; i++)
+        x.push_back(-10.0 + 20.0 * i / GRID);
+    for (double h = 1.0; h > 1e-300; h *= 0.5) {
+        x.push_back(h);
+        x.push_back(M_PI - h);
+        x.push_back(M_PI / 2 + h);
+    }
+
+    expected.resize(x.size());
+    actual.resize(x.size());
+    ln_sin_batch_scalar(x.data(), expected.data(), x.size());
+    kernel(x.data(), actual.data(), x.size());
+
+    double max_ulp = 0.0;
+    for (std::size_t i = 0; i < x.size(); i++)
+        max_ulp = std::max(max_ulp, ulp_distance(expected[i], actual[i]));
+
+    return max_ulp;
+}
+
+
+batch_integrand_t ln_sin_batch() {
+    static batch_integrand_t kernel = [] {
+        batch_integrand_t selected = select_kernel();
+
+        if (selected != ln_sin_batch_scalar && !(ln_sin_max_ulp(selected) <= LN_SIN_MAX_ULP)) {
+            std::cerr << "[ WARNING ]: vectorized ln(sin(x)) exceeds " << LN_SIN_MAX_ULP
+                      << " ULP, falling back to scalar\n";
+            selected = ln_sin_batch_scalar;
+        }
+
+        return selected;
+    }();
+
+    return kernel;
+}
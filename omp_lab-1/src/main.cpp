@@ -2,83 +2,232 @@
 #include <iomanip>
 #include <cmath>
 #include <fstream>
-#include <limits>
+#include <map>
+#include <vector>
+#include <string>
+#include <cstdint>
 #include <omp.h>
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
 
 #include "omp_estimator.h"
+#include "integrators.h"
+#include "integrands.h"
 
 
 
+// Rank of the process and number of processes, a single one without MPI
+int mpi_rank = 0;
+int mpi_size = 1;
+
+
+// Every rank reads the same input, so the failures are met by all of them at once
 void report_failure(std::string_view msg) {
-    std::cerr << "[ ERROR ]: " << msg << '\n';
+    if (mpi_rank == 0)
+        std::cerr << "[ ERROR ]: " << msg << '\n';
+#ifdef USE_MPI
+    MPI_Finalize();
+#endif
     std::exit(EXIT_FAILURE);
 }
 
 
-double f_x(double x) {
-    return std::log(std::sin(x));
+// The result of a query is written anyway, rank 0 prints the warning once per query
+void report_warning(std::string_view msg, std::size_t line) {
+    if (mpi_rank == 0)
+        std::cerr << "[ WARNING ]: line " << line << ": " << msg << '\n';
 }
 
 
-double get_integral(double (*func)(double), double left, double right, double err_val) {
-    double area = std::numeric_limits<double>::max();
-    double step = right - left;
-    double area_prev;
-    
-    omp_estimator::timer_begin();
-    do {
-        area_prev = area;
-        area = 0.0;
-
-        #pragma omp parallel for reduction(+: area) schedule(runtime)
-        for (int i = 0; i < (right - left) / step; i++) {
-            area += func(left + step / 2 + i * step) * step;
-        }
-        step = step / 2;
-        
-    } while (std::abs(area - area_prev) / 3 >= err_val );
-    omp_estimator::timer_end();
-    
-    return area;
+constexpr std::string_view UNCONVERGED_MSG = "refinement limit reached, the error estimate exceeds Epsilon";
+
+
+typedef double (*integral_t)(double, double, double);
+
+// A collective engine makes MPI calls, so it is run by the master thread only
+struct Engine {
+    integral_t omp;
+    integral_t no_omp;
+    bool collective = false;
+};
+
+typedef std::map<std::string_view, Engine> EngineTable;
+
+
+// Binds an engine instantiated for Func to a default constructed integrand
+template <class Func, auto integral>
+double bind_integrand(double left, double right, double err_val) {
+    return integral(Func(), left, right, err_val);
 }
 
 
-double get_integral_no_omp(double (*func)(double), double left, double right, double err_val) {
-    double area = std::numeric_limits<double>::max();
-    double step = right - left;
-    double area_prev;
-    
-    omp_estimator::timer_begin();
-    do  {
-        area_prev = area;
-        area = 0.0;
-        
-        for (int i = 0; i < (right - left) / step; i++) {
-            area += func(left + step / 2 + i * step) * step;
-        }
-        step = step / 2;
+template <class Func>
+const EngineTable engines = {
+    {"per_pass",   {bind_integrand<Func, get_integral<Func>>, bind_integrand<Func, get_integral_no_omp<Func>>}},
+    {"persistent", {bind_integrand<Func, get_integral_persistent<Func>>, bind_integrand<Func, get_integral_no_omp<Func>>}},
+    {"speculative", {bind_integrand<Func, get_integral_speculative<Func>>, bind_integrand<Func, get_integral_no_omp<Func>>}},
+    {"romberg",    {bind_integrand<Func, get_integral_romberg<Func>>, bind_integrand<Func, get_integral_romberg_no_omp<Func>>}},
+    {"adaptive",   {bind_integrand<Func, get_integral_adaptive<Func>>, bind_integrand<Func, get_integral_adaptive_no_omp<Func>>}},
+    {"gk15",       {bind_integrand<Func, get_integral_gauss_kronrod<GK15, Func>>,
+                    bind_integrand<Func, get_integral_gauss_kronrod_no_omp<GK15, Func>>}},
+    {"gk21",       {bind_integrand<Func, get_integral_gauss_kronrod<GK21, Func>>,
+                    bind_integrand<Func, get_integral_gauss_kronrod_no_omp<GK21, Func>>}},
+    {"simd",       {bind_integrand<Func, get_integral_simd<Func>>, bind_integrand<Func, get_integral_simd_no_omp<Func>>}},
+#ifdef USE_MPI
+    {"mpi",        {bind_integrand<Func, get_integral_mpi<Func>>, bind_integrand<Func, get_integral_mpi_no_omp<Func>>, true}}
+#endif
+};
 
-    } while (std::abs(area - area_prev) / 3 >= err_val );
-    omp_estimator::timer_end();
-    
-    return area;
+// Every integrand has the whole set of engines compiled for it
+const std::map<std::string_view, const EngineTable *> integrands = {
+    {"ln_sin", &engines<LnSin>},
+    {"poly3",  &engines<Poly3>},
+    {"poly8",  &engines<Poly8>},
+    {"exp",    &engines<Exp>},
+    {"osc",    &engines<Oscillatory>}
+};
+
+
+// Takes a word as an integrand or an engine name, returns false if it is neither
+bool select_option(const std::string &word, std::string &engine_name, std::string &integrand_name) {
+    if (integrands.count(word))
+        integrand_name = word;
+    else if (engines<LnSin>.count(word))
+        engine_name = word;
+    else
+        return false;
+
+    return true;
+}
+
+
+// Reads an optional word following the values on the same line of the input,
+// a carriage return of a CRLF line end is skipped as a whitespace
+std::string read_line_option(std::istream &in) {
+    std::string option;
+
+    while (in.peek() == ' ' || in.peek() == '\t' || in.peek() == '\r')
+        in.get();
+
+    if (in.peek() != '\n' && in.peek() != std::char_traits<char>::eof())
+        in >> option;
+
+    return option;
+}
+
+
+struct Query {
+    double left, right, err_val;
+    const Engine *engine;
+};
+
+
+// Parses a line of the input, returns the description of an error or an empty string
+std::string_view read_query(std::istream &in, const std::string &engine_default,
+                            const std::string &integrand_default, Query &query) {
+    std::string engine_name = engine_default;
+    std::string integrand_name = integrand_default;
+    bool options_known = true;
+
+    in >> query.left >> query.right >> query.err_val;
+
+    for (auto word = ::read_line_option(in); !word.empty(); word = ::read_line_option(in))
+        options_known = ::select_option(word, engine_name, integrand_name) && options_known;
+    in >> std::ws;
+
+    if (in.fail())
+        return "Unable to read from file";
+
+    if (query.err_val <= 0)
+        return "error_rate is out of range";
+
+    if (!options_known)
+        return "Unknown integration engine";
+
+    query.engine = &integrands.at(integrand_name)->at(engine_name);
+    return "";
+}
+
+
+// Queries with Epsilon not below this are cheap enough to be solved serially, many at once
+constexpr double BATCH_OUTER_MIN_EPS = 1e-4;
+
+
+// Solves all the queries, results and their convergence are stored in input
+// order. Cheap queries are spread over the team, expensive and collective ones
+// are solved one by one by the whole team.
+// Returns the total number of integrand calls
+std::int64_t solve_batch(const std::vector<Query> &queries, std::vector<double> &results,
+                         std::vector<char> &converged, bool omp_enable) {
+    std::vector<std::size_t> cheap, expensive;
+    std::int64_t calls = 0;
+
+    for (std::size_t i = 0; i < queries.size(); i++)
+        (queries[i].err_val >= BATCH_OUTER_MIN_EPS && !queries[i].engine->collective ? cheap : expensive).push_back(i);
+
+    results.resize(queries.size());
+    converged.resize(queries.size());
+
+    #pragma omp parallel for reduction(+: calls) schedule(dynamic) if(omp_enable)
+    for (std::size_t j = 0; j < cheap.size(); j++) {
+        const Query &query = queries[cheap[j]];
+        integral_converged = true;
+        results[cheap[j]] = query.engine->no_omp(query.left, query.right, query.err_val);
+        converged[cheap[j]] = integral_converged;
+        calls += integrand_calls;
+    }
+
+    for (auto i: expensive) {
+        const Query &query = queries[i];
+        auto func = omp_enable ? query.engine->omp : query.engine->no_omp;
+        integral_converged = true;
+        results[i] = func(query.left, query.right, query.err_val);
+        converged[i] = integral_converged;
+        calls += integrand_calls;
+    }
+
+    return calls;
 }
 
 
 int main(int argc, char* argv[]) {
     
-    if (argc != 4)
+#ifdef USE_MPI
+    // Only the master thread of a rank calls MPI, outside of the parallel regions
+    int mpi_thread_level;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &mpi_thread_level);
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+
+    if (mpi_thread_level < MPI_THREAD_FUNNELED)
+        ::report_failure("MPI does not support threads");
+#endif
+
+    if (argc < 4 || argc > 7)
         ::report_failure("Invalid number of arguments\n");
     
-    double left_bound, right_bound, error_rate;
     bool omp_enable_flag = true;
+    bool batch_flag = false;
 
+    // Rank 0 is the only one to write the results and the timings
     std::ifstream fin(argv[1]);
-    std::ofstream fout(argv[2]);
+    std::ofstream fout;
     fout << std::fixed << std::setprecision(5);
     int thr_num = std::atoi(argv[3]);
+    int fout_open = 1;
+
+    if (mpi_rank == 0) {
+        fout.open(argv[2]);
+        fout_open = fout.is_open();
+    } else {
+        std::cout.setstate(std::ios_base::badbit);
+    }
+#ifdef USE_MPI
+    MPI_Bcast(&fout_open, 1, MPI_INT, 0, MPI_COMM_WORLD);
+#endif
     
-    if (!fin.is_open() || !fout.is_open())
+    if (!fin.is_open() || !fout_open)
         ::report_failure("Unable to open file");
     
     if (thr_num < -1)
@@ -90,34 +239,98 @@ int main(int argc, char* argv[]) {
         default: omp_set_num_threads(thr_num); break;
     }
     
+    std::string engine_default = "per_pass";
+    std::string integrand_default = "ln_sin";
+
+    for (int i = 4; i < argc; i++) {
+        if (std::string_view(argv[i]) == "batch")
+            batch_flag = true;
+        else if (!::select_option(argv[i], engine_default, integrand_default))
+            ::report_failure("Unknown integration engine");
+    }
+
+    // Queries of a batch are taken by threads in no particular order, while
+    // collective calls must be made by all ranks in the same one
+    if (batch_flag && mpi_size > 1)
+        ::report_failure("Batch mode is not supported by multiple ranks");
+
+    if (batch_flag) {
+        std::vector<Query> queries;
+        std::vector<double> results;
+        std::vector<char> converged;
+
+        while (!fin.eof()) {
+            Query query;
+            std::string_view error = ::read_query(fin, engine_default, integrand_default, query);
+
+            if (!error.empty()) {
+                fin.close();
+                fout.close();
+                ::report_failure(error);
+            }
+            queries.push_back(query);
+        }
+
+        double time_begin = omp_get_wtime();
+        std::int64_t calls = ::solve_batch(queries, results, converged, omp_enable_flag);
+        double time_elapsed = omp_get_wtime() - time_begin;
+
+        std::cout << "Time (" << thr_num << " thread(s)): "
+                  << time_elapsed * 1000 << " ms\n";
+        std::cout << "Evaluations: " << calls << '\n';
+        // Fixed notation, large rates would be printed with an exponent otherwise
+        std::cout << "Throughput: " << std::fixed << std::setprecision(0)
+                  << queries.size() / time_elapsed << " queries/s\n";
+
+        for (std::size_t i = 0; i < queries.size(); i++) {
+            if (!converged[i])
+                ::report_warning(UNCONVERGED_MSG, i + 1);
+            fout << results[i] << '\n';
+        }
+
+        fin.close();
+        fout.close();
+#ifdef USE_MPI
+        MPI_Finalize();
+#endif
+
+        return 0;
+    }
+
     omp_estimator::PerformanceEstimator est;
-    auto func = omp_enable_flag ? get_integral : get_integral_no_omp;
+    std::size_t line = 0;
 
     while (!fin.eof()) {
-        fin >> left_bound >> right_bound >> error_rate >> std::ws;
-        
-        if (fin.fail()) {
-            fin.close();
-            fout.close();
-            ::report_failure("Unable to read from file");
-        }
+        Query query;
+        std::string_view error = ::read_query(fin, engine_default, integrand_default, query);
 
-        if (error_rate <= 0) {
+        if (!error.empty()) {
             fin.close();
             fout.close();
-            ::report_failure("error_rate is out of range");
+            ::report_failure(error);
         }
 
-        est.estimate(func, &f_x, left_bound, right_bound, error_rate);
+        auto func = omp_enable_flag ? query.engine->omp : query.engine->no_omp;
+        line++;
+
+        integral_converged = true;
+        est.estimate(func, query.left, query.right, query.err_val);
+
+        if (!integral_converged)
+            ::report_warning(UNCONVERGED_MSG, line);
 
         std::cout << "Time (" << thr_num << " thread(s)): "
                   << est.get_elapsed_time() << " ms\n";
+        std::cout << "Evaluations: " << integrand_calls << '\n';
         
         fout << std::any_cast<double>(est.get_return_value()) << '\n';
     };
     
     fin.close();
     fout.close();
+#ifdef USE_MPI
+    MPI_Finalize();
+#endif
     
     return 0;
-}
\ No newline at end of file
+}
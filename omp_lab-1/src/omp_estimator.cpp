@@ -3,8 +3,8 @@
 
 namespace omp_estimator {
 
-    std::chrono::_V2::steady_clock::time_point PerformanceEstimator::begin;
-    std::chrono::_V2::steady_clock::time_point PerformanceEstimator::end;
+    thread_local std::chrono::_V2::steady_clock::time_point PerformanceEstimator::begin;
+    thread_local std::chrono::_V2::steady_clock::time_point PerformanceEstimator::end;
 
 
     double PerformanceEstimator::get_elapsed_time() {
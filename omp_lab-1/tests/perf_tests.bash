@@ -140,3 +140,299 @@ $EXEC /dev/stdin $OUTPUT_FILE 1 1>>$TEST_RESULTS <<< $INPUT_FILE
 # Single Thread, OMP disabled
 echo "[1 thr, no omp]" >> $TEST_RESULTS
 $EXEC /dev/stdin $OUTPUT_FILE -1 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+
+
+INPUT_FILE='''
+0 3.14159265358979323846 0.1
+0 3.14159265358979323846 0.01
+0 3.14159265358979323846 0.001
+0 3.14159265358979323846 0.0001
+0 3.14159265358979323846 0.00001
+0 3.14159265358979323846 0.000001
+'''
+TEST_RESULTS=$DATA_FOLDER/perf_test_persistent.txt
+
+
+echo "[ INFO ] evaluating per-pass against persistent parallel region; $TEST_RESULTS"
+
+echo -n > $TEST_RESULTS
+for schedule in static,1 static,2 static,3 static,4 static,8 static,16 static dynamic guided; do
+    export OMP_SCHEDULE=$schedule
+
+    echo "[Per-pass, ${schedule/,/_}]" >> $TEST_RESULTS
+    $EXEC /dev/stdin $OUTPUT_FILE 0 per_pass 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+    echo "[Persistent, ${schedule/,/_}]" >> $TEST_RESULTS
+    $EXEC /dev/stdin $OUTPUT_FILE 0 persistent 1>>$TEST_RESULTS <<< $INPUT_FILE
+done
+
+
+
+INPUT_FILE='''
+0 3.14159265358979323846 0.1
+0 3.14159265358979323846 0.01
+0 3.14159265358979323846 0.001
+0 3.14159265358979323846 0.0001
+0 3.14159265358979323846 0.00001
+0 3.14159265358979323846 0.000001
+'''
+TEST_RESULTS=$DATA_FOLDER/perf_test_romberg.txt
+
+
+echo "[ INFO ] evaluating performance per integration engine; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# All Threads, per-pass region
+echo "[All thr, per_pass]" > $TEST_RESULTS
+$EXEC /dev/stdin $OUTPUT_FILE 0 per_pass 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+# All Threads, romberg
+echo "[All thr, romberg]" >> $TEST_RESULTS
+$EXEC /dev/stdin $OUTPUT_FILE 0 romberg 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+# Single Thread, OMP disabled, romberg
+echo "[1 thr, romberg no omp]" >> $TEST_RESULTS
+$EXEC /dev/stdin $OUTPUT_FILE -1 romberg 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+
+
+INPUT_FILE='''
+0 3.14159265358979323846 0.1
+0 3.14159265358979323846 0.01
+0 3.14159265358979323846 0.001
+0 3.14159265358979323846 0.0001
+0 3.14159265358979323846 0.00001
+0 3.14159265358979323846 0.000001
+'''
+TEST_RESULTS=$DATA_FOLDER/perf_test_adaptive.txt
+
+
+echo "[ INFO ] evaluating uniform against adaptive subdivision; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# All Threads, uniform halving
+echo "[All thr, uniform]" > $TEST_RESULTS
+$EXEC /dev/stdin $OUTPUT_FILE 0 per_pass 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+# All Threads, adaptive tasks
+echo "[All thr, adaptive]" >> $TEST_RESULTS
+$EXEC /dev/stdin $OUTPUT_FILE 0 adaptive 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+# 4 Threads, adaptive tasks
+echo "[4 thr, adaptive]" >> $TEST_RESULTS
+$EXEC /dev/stdin $OUTPUT_FILE 4 adaptive 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+# Single Thread, OMP disabled, adaptive
+echo "[1 thr, adaptive no omp]" >> $TEST_RESULTS
+$EXEC /dev/stdin $OUTPUT_FILE -1 adaptive 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+
+
+INPUT_FILE='''
+0 3.14159265358979323846 0.1
+0 3.14159265358979323846 0.01
+0 3.14159265358979323846 0.001
+0 3.14159265358979323846 0.0001
+0 3.14159265358979323846 0.00001
+0 3.14159265358979323846 0.000001
+'''
+TEST_RESULTS=$DATA_FOLDER/perf_test_gauss_kronrod.txt
+
+
+echo "[ INFO ] evaluating cost per accuracy of quadrature rules; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# All Threads, centered rectangles
+echo "[All thr, rectangles]" > $TEST_RESULTS
+$EXEC /dev/stdin $OUTPUT_FILE 0 per_pass 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+# All Threads, G7-K15
+echo "[All thr, gk15]" >> $TEST_RESULTS
+$EXEC /dev/stdin $OUTPUT_FILE 0 gk15 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+# All Threads, G10-K21
+echo "[All thr, gk21]" >> $TEST_RESULTS
+$EXEC /dev/stdin $OUTPUT_FILE 0 gk21 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+
+
+INPUT_FILE='''
+0 3.14159265358979323846 0.1
+0 3.14159265358979323846 0.01
+0 3.14159265358979323846 0.001
+0 3.14159265358979323846 0.0001
+0 3.14159265358979323846 0.00001
+0 3.14159265358979323846 0.000001
+'''
+TEST_RESULTS=$DATA_FOLDER/perf_test_simd.txt
+
+
+echo "[ INFO ] evaluating performance from vectorized integrand; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# All Threads, scalar library calls
+echo "[All thr, libm]" > $TEST_RESULTS
+$EXEC /dev/stdin $OUTPUT_FILE 0 per_pass 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+# All Threads, every batch kernel
+for kernel in scalar avx2 avx512
+do
+    echo "[All thr, $kernel]" >> $TEST_RESULTS
+    LN_SIN_KERNEL=$kernel $EXEC /dev/stdin $OUTPUT_FILE 0 simd 1>>$TEST_RESULTS <<< $INPUT_FILE
+done
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_integrands.txt
+
+
+echo "[ INFO ] evaluating performance from integrand; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# All Threads, every compiled-in integrand over the same Epsilon sweep
+echo -n "" > $TEST_RESULTS
+for integrand in ln_sin poly3 poly8 exp osc
+do
+    echo "[All thr, $integrand]" >> $TEST_RESULTS
+    $EXEC /dev/stdin $OUTPUT_FILE 0 per_pass $integrand 1>>$TEST_RESULTS <<< '''
+0 1 0.1
+0 1 0.01
+0 1 0.001
+0 1 0.0001
+0 1 0.00001
+0 1 0.000001
+'''
+done
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_batch.txt
+
+
+echo "[ INFO ] evaluating throughput of batch mode; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# Thousands of cheap queries and a few expensive ones
+INPUT_FILE=$(for i in $(seq 1 1000)
+do
+    echo "0 3.14159265358979323846 0.$(printf '%0*d' $(( i % 3 + 1 )) 1)"
+    echo "0 1 0.001 exp"
+done; echo "0 3.14159265358979323846 0.000001")
+
+# Single thread, no omp
+echo "[Batch, no_omp]" > $TEST_RESULTS
+$EXEC /dev/stdin $OUTPUT_FILE -1 batch 1>>$TEST_RESULTS <<< $INPUT_FILE
+
+# Growing number of threads
+for threads in 1 2 4 8
+do
+    echo "[Batch, thr_$threads]" >> $TEST_RESULTS
+    $EXEC /dev/stdin $OUTPUT_FILE $threads batch 1>>$TEST_RESULTS <<< $INPUT_FILE
+done
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_precision.txt
+
+
+echo "[ INFO ] evaluating performance of extreme precision; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# Every integral is solved once (batch mode), beyond 1e-9 it takes over 2^31 samples
+echo -n "" > $TEST_RESULTS
+for engine in per_pass simd
+do
+    echo "[All thr, $engine]" >> $TEST_RESULTS
+    for epsilon in 0.000001 0.0000001 0.00000001 0.000000001 0.0000000001
+    do
+        $EXEC /dev/stdin $OUTPUT_FILE 0 batch $engine 1>>$TEST_RESULTS <<< "0 3.14159265358979323846 $epsilon"
+    done
+done
+
+
+
+INPUT_FILE='''
+0 3.14159265358979323846 0.1
+0 3.14159265358979323846 0.01
+0 3.14159265358979323846 0.001
+0 3.14159265358979323846 0.0001
+0 3.14159265358979323846 0.00001
+0 3.14159265358979323846 0.000001
+'''
+TEST_RESULTS=$DATA_FOLDER/perf_test_speculative.txt
+
+
+echo "[ INFO ] evaluating performance from speculative refinement; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# 2 and 8 threads (the configurations of the charts above), sequential and speculative levels.
+# The gain comes from the cores left idle by a short pass, the threads must have a core each
+if [ "$(nproc)" -lt 8 ]; then
+    echo "[ WARNING ] $(nproc) core(s) only, the threads share them and the speculation can only add its cost"
+fi
+
+echo -n "" > $TEST_RESULTS
+for threads in 2 8
+do
+    for engine in per_pass speculative
+    do
+        echo "[$threads thr, $engine]" >> $TEST_RESULTS
+        $EXEC /dev/stdin $OUTPUT_FILE $threads $engine 1>>$TEST_RESULTS <<< $INPUT_FILE
+    done
+done
+
+
+
+MPI_EXEC=./build/omp_lab1_mpi.elf
+MPI_INPUT_FILE=$DATA_FOLDER/perf_input_mpi.txt
+TEST_RESULTS=$DATA_FOLDER/perf_test_mpi.txt
+
+
+if [ -x "$MPI_EXEC" ] && command -v mpirun > /dev/null; then
+    echo "[ INFO ] evaluating strong scaling over MPI ranks; $TEST_RESULTS"
+
+    export OMP_SCHEDULE=static
+    echo "0 3.14159265358979323846 0.000001" > $MPI_INPUT_FILE
+
+    # Strong scaling needs a core per rank, the ranks beyond the cores share them
+    if [ "$(nproc)" -lt 8 ]; then
+        echo "[ WARNING ] $(nproc) core(s) only, the ranks share them and do not scale"
+    fi
+
+    # Runs the integral by $1 ranks of $2 threads, the speedup and the efficiency (the speedup
+    # per thread of all the ranks) are taken against the first run, a single rank of a thread
+    serial_time=
+    run_ranks() {
+        local time=$(mpirun --oversubscribe -np $1 $MPI_EXEC $MPI_INPUT_FILE $OUTPUT_FILE $2 mpi |
+                     tee -a $TEST_RESULTS | awk '/^Time/ {print $(NF - 1)}')
+        [ -z "$serial_time" ] && serial_time=$time
+        awk -v serial=$serial_time -v time=$time -v threads=$(( $1 * $2 )) \
+            'BEGIN {printf "Speedup: %.2f\nEfficiency: %.0f %%\n", serial / time, 100 * serial / (time * threads)}' >> $TEST_RESULTS
+    }
+
+    # Same integral for a growing number of ranks, a single thread per rank
+    echo -n "" > $TEST_RESULTS
+    for ranks in 1 2 4 8
+    do
+        echo "[MPI, ranks_$ranks]" >> $TEST_RESULTS
+        run_ranks $ranks 1
+    done
+
+    # Hybrid: 8 threads in total split between ranks and OpenMP teams
+    for ranks in 1 2 4 8
+    do
+        echo "[Hybrid, ${ranks}x$(( 8 / ranks ))]" >> $TEST_RESULTS
+        run_ranks $ranks $(( 8 / ranks ))
+    done
+else
+    echo "[ INFO ] $MPI_EXEC is not built (make mpi), strong scaling skipped"
+fi
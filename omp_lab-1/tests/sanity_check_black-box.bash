@@ -156,6 +156,312 @@ assert "$(<$OUTPUT_FILE)" "[ ERROR ]: error_rate is out of range"
 
 
 
+echo; echo "GROUP: persistent parallel region"
+
+# POSITIVE: single thread, persistent region, TC_25
+$EXEC /dev/stdin $OUTPUT_FILE 1 persistent 1> /dev/null <<< '0 3.14159265358979323846 0.00001'
+assert "$(<$OUTPUT_FILE)" "-2.17757"
+
+# POSITIVE: 4 threads, persistent region, TC_26
+$EXEC /dev/stdin $OUTPUT_FILE 4 persistent 1> /dev/null <<< '0 3.14159265358979323846 0.00001'
+assert "$(<$OUTPUT_FILE)" "-2.17757"
+
+# POSITIVE: all threads, persistent region, several lines, TC_27
+$EXEC /dev/stdin $OUTPUT_FILE 0 persistent 1> /dev/null <<< '''0 3.14159265358979323846 0.1
+4 6 0.00001'''
+assert "$(<$OUTPUT_FILE)" "$(printf -- '-1.90539\n-nan')"
+
+# NEGATIVE: unknown engine, TC_28
+$EXEC /dev/stdin $OUTPUT_FILE 0 unknown 1> /dev/null 2> $OUTPUT_FILE <<< '0 3.14159265358979323846 0.00001'
+assert "$(<$OUTPUT_FILE)" "[ ERROR ]: Unknown integration engine"
+
+
+
+echo; echo "GROUP: romberg engine"
+
+# POSITIVE: single thread, no omp, romberg, TC_29
+$EXEC /dev/stdin $OUTPUT_FILE -1 romberg 1> /dev/null <<< '0 3.14159265358979323846 0.00001'
+assert "$(<$OUTPUT_FILE)" "-2.17759"
+
+# POSITIVE: all threads, romberg, TC_30
+$EXEC /dev/stdin $OUTPUT_FILE 0 romberg 1> /dev/null <<< '0 3.14159265358979323846 0.00001'
+assert "$(<$OUTPUT_FILE)" "-2.17759"
+
+# POSITIVE: all threads, romberg, smooth integrand, TC_31
+$EXEC /dev/stdin $OUTPUT_FILE 0 romberg 1> /dev/null <<< '-6 -4 0.00001'
+assert "$(<$OUTPUT_FILE)" "-0.51071"
+
+# POSITIVE: all threads, romberg, infinite area, TC_32
+$EXEC /dev/stdin $OUTPUT_FILE 0 romberg 1> /dev/null <<< '4 6 0.00001'
+assert "$(<$OUTPUT_FILE)" "-nan"
+
+# POSITIVE: all threads, romberg, zero distance between bounds, TC_33
+$EXEC /dev/stdin $OUTPUT_FILE 0 romberg 1> /dev/null <<< '3.14159265358979323846 3.14159265358979323846 0.00001'
+assert "$(<$OUTPUT_FILE)" "0.00000"
+
+# POSITIVE: single thread, no omp, and all threads, romberg, zero width at singularity, TC_34
+no_omp=$($EXEC /dev/stdin $OUTPUT_FILE -1 romberg 1> /dev/null <<< '0 0 0.001'; cat $OUTPUT_FILE)
+evaluations=$($EXEC /dev/stdin $OUTPUT_FILE 0 romberg <<< '0 0 0.001' | grep -o 'Evaluations: [0-9]*')
+assert "$no_omp;$(<$OUTPUT_FILE);$evaluations" "0.00000;0.00000;Evaluations: 0"
+
+
+
+echo; echo "GROUP: adaptive engine"
+
+# POSITIVE: single thread, no omp, adaptive, TC_35
+$EXEC /dev/stdin $OUTPUT_FILE -1 adaptive 1> /dev/null <<< '0 3.14159265358979323846 0.00001'
+assert "$(<$OUTPUT_FILE)" "-2.17758"
+
+# POSITIVE: all threads, adaptive, TC_36
+$EXEC /dev/stdin $OUTPUT_FILE 0 adaptive 1> /dev/null <<< '0 3.14159265358979323846 0.000001'
+assert "$(<$OUTPUT_FILE)" "-2.17759"
+
+# POSITIVE: all threads, adaptive, negative interval, TC_37
+$EXEC /dev/stdin $OUTPUT_FILE 0 adaptive 1> /dev/null <<< '-6 -4 0.00001'
+assert "$(<$OUTPUT_FILE)" "-0.51071"
+
+# POSITIVE: all threads, adaptive, infinite area, TC_38
+$EXEC /dev/stdin $OUTPUT_FILE 0 adaptive 1> /dev/null <<< '4 6 0.00001'
+assert "$(<$OUTPUT_FILE)" "-nan"
+
+# POSITIVE: single thread, no omp, and all threads, adaptive, zero width at singularity, TC_39
+no_omp=$($EXEC /dev/stdin $OUTPUT_FILE -1 adaptive 1> /dev/null <<< '0 0 0.001'; cat $OUTPUT_FILE)
+evaluations=$($EXEC /dev/stdin $OUTPUT_FILE 0 adaptive <<< '0 0 0.001' | grep -o 'Evaluations: [0-9]*')
+assert "$no_omp;$(<$OUTPUT_FILE);$evaluations" "0.00000;0.00000;Evaluations: 0"
+
+# POSITIVE: adaptive takes fewer evaluations than uniform halving, TC_40
+uniform=$($EXEC /dev/stdin $OUTPUT_FILE 0 per_pass <<< '0 3.14159265358979323846 0.00001' | grep -o 'Evaluations: [0-9]*')
+adaptive=$($EXEC /dev/stdin $OUTPUT_FILE 0 adaptive <<< '0 3.14159265358979323846 0.00001' | grep -o 'Evaluations: [0-9]*')
+assert "$(( ${adaptive#*: } < ${uniform#*: } ))" "1"
+
+
+
+echo; echo "GROUP: gauss-kronrod engines"
+
+# POSITIVE: single thread, no omp, G7-K15, TC_41
+$EXEC /dev/stdin $OUTPUT_FILE -1 gk15 1> /dev/null <<< '0 3.14159265358979323846 0.00001'
+assert "$(<$OUTPUT_FILE)" "-2.17758"
+
+# POSITIVE: all threads, G7-K15, TC_42
+$EXEC /dev/stdin $OUTPUT_FILE 0 gk15 1> /dev/null <<< '0 3.14159265358979323846 0.000001'
+assert "$(<$OUTPUT_FILE)" "-2.17759"
+
+# POSITIVE: all threads, G10-K21, TC_43
+$EXEC /dev/stdin $OUTPUT_FILE 0 gk21 1> /dev/null <<< '0 3.14159265358979323846 0.000001'
+assert "$(<$OUTPUT_FILE)" "-2.17759"
+
+# POSITIVE: all threads, G10-K21, infinite area, TC_44
+$EXEC /dev/stdin $OUTPUT_FILE 0 gk21 1> /dev/null <<< '4 6 0.00001'
+assert "$(<$OUTPUT_FILE)" "-nan"
+
+# POSITIVE: single thread, no omp, G7-K15, and all threads, G10-K21, zero width at singularity, TC_45
+no_omp=$($EXEC /dev/stdin $OUTPUT_FILE -1 gk15 1> /dev/null <<< '0 0 0.001'; cat $OUTPUT_FILE)
+evaluations=$($EXEC /dev/stdin $OUTPUT_FILE 0 gk21 <<< '0 0 0.001' | grep -o 'Evaluations: [0-9]*')
+assert "$no_omp;$(<$OUTPUT_FILE);$evaluations" "0.00000;0.00000;Evaluations: 0"
+
+# POSITIVE: engine chosen per input line, TC_46
+$EXEC /dev/stdin $OUTPUT_FILE 0 1> /dev/null <<< '''0 3.14159265358979323846 0.00001 gk21
+0 3.14159265358979323846 0.00001
+0 3.14159265358979323846 0.00001 romberg'''
+assert "$(<$OUTPUT_FILE)" "$(printf -- '-2.17758\n-2.17757\n-2.17759')"
+
+# NEGATIVE: unknown engine in input line, TC_47
+$EXEC /dev/stdin $OUTPUT_FILE 0 1> /dev/null 2> $OUTPUT_FILE <<< '0 3.14159265358979323846 0.00001 gk'
+assert "$(<$OUTPUT_FILE)" "[ ERROR ]: Unknown integration engine"
+
+# POSITIVE: CRLF line ends, with and without an engine, TC_48
+printf -- '0 3.14159265358979323846 0.00001 gk21\r\n0 3.14159265358979323846 0.00001\r\n' > $OUTPUT_FILE.crlf
+$EXEC $OUTPUT_FILE.crlf $OUTPUT_FILE 0 1> /dev/null
+assert "$(<$OUTPUT_FILE)" "$(printf -- '-2.17758\n-2.17757')"
+
+
+
+echo; echo "GROUP: simd engine"
+
+# POSITIVE: single thread, no omp, vectorized integrand, TC_49
+$EXEC /dev/stdin $OUTPUT_FILE -1 simd 1> /dev/null <<< '0 3.14159265358979323846 0.00001'
+assert "$(<$OUTPUT_FILE)" "-2.17757"
+
+# POSITIVE: all threads, vectorized integrand, TC_50
+$EXEC /dev/stdin $OUTPUT_FILE 0 simd 1> /dev/null <<< '0 3.14159265358979323846 0.000001'
+assert "$(<$OUTPUT_FILE)" "-2.17758"
+
+# POSITIVE: all threads, forced scalar kernel, TC_51
+LN_SIN_KERNEL=scalar $EXEC /dev/stdin $OUTPUT_FILE 0 simd 1> /dev/null <<< '-6 -4 0.00001'
+assert "$(<$OUTPUT_FILE)" "-0.51071"
+
+# POSITIVE: all threads, vectorized integrand, infinite area, TC_52
+$EXEC /dev/stdin $OUTPUT_FILE 0 simd 1> /dev/null <<< '4 6 0.00001'
+assert "$(<$OUTPUT_FILE)" "-nan"
+
+# POSITIVE: all threads, vectorized integrand, zero width, TC_53
+$EXEC /dev/stdin $OUTPUT_FILE 0 simd 1> /dev/null <<< '3.14159265358979323846 3.14159265358979323846 0.00001'
+assert "$(<$OUTPUT_FILE)" "0.00000"
+
+
+
+echo; echo "GROUP: integrand registry"
+
+# POSITIVE: single thread, no omp, cubic polynomial, TC_54
+$EXEC /dev/stdin $OUTPUT_FILE -1 1> /dev/null <<< '0 1 0.000001 poly3'
+assert "$(<$OUTPUT_FILE)" "-0.50000"
+
+# POSITIVE: all threads, polynomial of degree 8, engine after integrand, TC_55
+$EXEC /dev/stdin $OUTPUT_FILE 0 1> /dev/null <<< '-1 1 0.000001 poly8 romberg'
+assert "$(<$OUTPUT_FILE)" "-0.03175"
+
+# POSITIVE: all threads, exponent, integrand passed in command line, TC_56
+$EXEC /dev/stdin $OUTPUT_FILE 0 gk21 exp 1> /dev/null <<< '0 1 0.000001'
+assert "$(<$OUTPUT_FILE)" "1.71828"
+
+# POSITIVE: all threads, oscillatory, batch engine, TC_57
+$EXEC /dev/stdin $OUTPUT_FILE 0 simd 1> /dev/null <<< '0 1 0.000001 osc'
+assert "$(<$OUTPUT_FILE)" "-0.00525"
+
+# POSITIVE: integrand chosen per input line, TC_58
+$EXEC /dev/stdin $OUTPUT_FILE 0 gk15 1> /dev/null <<< '''0 1 0.000001 exp
+0 3.14159265358979323846 0.000001
+0 1 0.000001 adaptive poly3'''
+assert "$(<$OUTPUT_FILE)" "$(printf -- '1.71828\n-2.17759\n-0.50000')"
+
+# NEGATIVE: unknown integrand in command line, TC_59
+$EXEC /dev/stdin $OUTPUT_FILE 0 gk15 poly 1> /dev/null 2> $OUTPUT_FILE <<< '0 1 0.000001'
+assert "$(<$OUTPUT_FILE)" "[ ERROR ]: Unknown integration engine"
+
+
+
+echo; echo "GROUP: batch mode"
+
+BATCH_INPUT='''0 3.14159265358979323846 0.1
+0 1 0.000001 exp gk15
+0 3.14159265358979323846 0.000001 romberg
+-6 -4 0.001
+0 1 0.01 poly3 adaptive
+0 3.14159265358979323846 0.00001'''
+
+# POSITIVE: single thread, no omp, results in input order, TC_60
+$EXEC /dev/stdin $OUTPUT_FILE -1 batch 1> /dev/null <<< $BATCH_INPUT
+assert "$(<$OUTPUT_FILE)" "$(printf -- '-1.90539\n1.71828\n-2.17759\n-0.51001\n-0.50000\n-2.17757')"
+
+# POSITIVE: all threads, results in input order, TC_61
+$EXEC /dev/stdin $OUTPUT_FILE 0 batch 1> /dev/null <<< $BATCH_INPUT
+assert "$(<$OUTPUT_FILE)" "$(printf -- '-1.90539\n1.71828\n-2.17759\n-0.51001\n-0.50000\n-2.17757')"
+
+# POSITIVE: all threads, same results as line by line, TC_62
+$EXEC /dev/stdin $OUTPUT_FILE 0 1> /dev/null <<< $BATCH_INPUT
+expected="$(<$OUTPUT_FILE)"
+$EXEC /dev/stdin $OUTPUT_FILE 0 batch 1> /dev/null <<< $BATCH_INPUT
+assert "$(<$OUTPUT_FILE)" "$expected"
+
+# POSITIVE: all threads, throughput is reported, TC_63
+assert "$($EXEC /dev/stdin $OUTPUT_FILE 0 batch gk21 <<< $BATCH_INPUT | grep -c 'Throughput: [0-9]* queries/s')" "1"
+
+# NEGATIVE: all threads, invalid line fails the whole batch, TC_64
+$EXEC /dev/stdin $OUTPUT_FILE 0 batch 1> /dev/null 2> $OUTPUT_FILE <<< '''0 1 0.01
+0 1 -0.01'''
+assert "$(<$OUTPUT_FILE)" "[ ERROR ]: error_rate is out of range"
+
+
+
+echo; echo "GROUP: 64-bit iteration space"
+
+# POSITIVE: single thread, no omp, zero width at singularity, TC_65
+$EXEC /dev/stdin $OUTPUT_FILE -1 1> /dev/null <<< '0 0 0.1'
+assert "$(<$OUTPUT_FILE)" "0.00000"
+
+# POSITIVE: all threads, zero width at singularity, persistent, TC_66
+$EXEC /dev/stdin $OUTPUT_FILE 0 persistent 1> /dev/null <<< '0 0 0.1'
+assert "$(<$OUTPUT_FILE)" "0.00000"
+
+# POSITIVE: all threads, zero width takes no evaluations, TC_67
+assert "$($EXEC /dev/stdin $OUTPUT_FILE 0 <<< '1 1 0.1' | grep -o 'Evaluations: [0-9]*')" "Evaluations: 0"
+
+# POSITIVE: all threads, high precision, TC_68
+$EXEC /dev/stdin $OUTPUT_FILE 0 batch 1> /dev/null <<< '0 1 0.0000000001 poly8'
+assert "$(<$OUTPUT_FILE)" "-0.01587"
+
+
+
+echo; echo "GROUP: speculative engine"
+
+SPECULATIVE_INPUT='''0 3.14159265358979323846 0.1
+0 3.14159265358979323846 0.00001
+-6 -4 0.00001
+0 1 0.0000001 exp
+4 6 0.00001
+0 0 0.1'''
+
+# POSITIVE: single thread, no omp, speculative, TC_69
+$EXEC /dev/stdin $OUTPUT_FILE -1 speculative 1> /dev/null <<< '0 3.14159265358979323846 0.00001'
+assert "$(<$OUTPUT_FILE)" "-2.17757"
+
+# POSITIVE: two threads, same results as per-pass loop, TC_70
+$EXEC /dev/stdin $OUTPUT_FILE 2 per_pass 1> /dev/null <<< $SPECULATIVE_INPUT
+expected="$(<$OUTPUT_FILE)"
+$EXEC /dev/stdin $OUTPUT_FILE 2 speculative 1> /dev/null <<< $SPECULATIVE_INPUT
+assert "$(<$OUTPUT_FILE)" "$expected"
+
+# POSITIVE: all threads, same results as per-pass loop, TC_71
+$EXEC /dev/stdin $OUTPUT_FILE 0 speculative 1> /dev/null <<< $SPECULATIVE_INPUT
+assert "$(<$OUTPUT_FILE)" "$expected"
+
+# POSITIVE: all threads, discarded levels are counted, TC_72
+uniform=$($EXEC /dev/stdin $OUTPUT_FILE 0 per_pass <<< '0 3.14159265358979323846 0.00001' | grep -o 'Evaluations: [0-9]*')
+speculative=$($EXEC /dev/stdin $OUTPUT_FILE 0 speculative <<< '0 3.14159265358979323846 0.00001' | grep -o 'Evaluations: [0-9]*')
+assert "$(( ${speculative#*: } >= ${uniform#*: } ))" "1"
+
+
+
+echo; echo "GROUP: hybrid MPI + OpenMP"
+
+MPI_EXEC=./build/omp_lab1_mpi.elf
+MPI_INPUT_FILE=data/test_input_mpi.txt
+
+# mpirun passes stdin to the rank 0 only, hence the input is a regular file
+if [ -x "$MPI_EXEC" ] && command -v mpirun > /dev/null; then
+    printf -- '0 3.14159265358979323846 0.00001\n-6 -4 0.00001\n0 1 0.000001 exp\n4 6 0.00001\n0 0 0.1\n' > $MPI_INPUT_FILE
+
+    # POSITIVE: single rank, no omp, TC_73
+    mpirun -np 1 $MPI_EXEC $MPI_INPUT_FILE $OUTPUT_FILE -1 mpi 1> /dev/null
+    assert "$(<$OUTPUT_FILE)" "$(printf -- '-2.17757\n-0.51071\n1.71828\n-nan\n0.00000')"
+
+    # POSITIVE: 2 ranks, 2 threads each, TC_74
+    mpirun --oversubscribe -np 2 $MPI_EXEC $MPI_INPUT_FILE $OUTPUT_FILE 2 mpi 1> /dev/null
+    assert "$(<$OUTPUT_FILE)" "$(printf -- '-2.17757\n-0.51071\n1.71828\n-nan\n0.00000')"
+
+    # POSITIVE: 4 ranks, single thread each, TC_75
+    mpirun --oversubscribe -np 4 $MPI_EXEC $MPI_INPUT_FILE $OUTPUT_FILE 1 mpi 1> /dev/null
+    assert "$(<$OUTPUT_FILE)" "$(printf -- '-2.17757\n-0.51071\n1.71828\n-nan\n0.00000')"
+
+    # NEGATIVE: 2 ranks, batch mode, TC_76
+    assert "$(mpirun --oversubscribe -np 2 $MPI_EXEC $MPI_INPUT_FILE $OUTPUT_FILE 1 mpi batch 2>&1 | grep -o '\[ ERROR \].*')" \
+           "[ ERROR ]: Batch mode is not supported by multiple ranks"
+
+    # POSITIVE: single rank, batch mode, cheap queries of the mpi engine are kept off the worker threads, TC_77
+    printf -- '0 3.14159265358979323846 0.001 mpi\n-6 -4 0.001 mpi\n0 1 0.001 exp mpi\n0 1 0.001 exp\n' > $MPI_INPUT_FILE
+    mpirun -np 1 $MPI_EXEC $MPI_INPUT_FILE $OUTPUT_FILE 4 1> /dev/null
+    expected="$(<$OUTPUT_FILE)"
+    mpirun -np 1 $MPI_EXEC $MPI_INPUT_FILE $OUTPUT_FILE 4 batch 1> /dev/null
+    assert "$(<$OUTPUT_FILE)" "$expected"
+else
+    echo "[ INFO ]: $MPI_EXEC is not built (make mpi) or mpirun is missing, skipped"
+fi
+
+
+
+echo; echo "GROUP: slow tests"
+
+# A pass of 2^31 samples, over INT_MAX, takes about a minute, hence it is run on demand
+if [ -n "$SLOW_TESTS" ]; then
+    # POSITIVE: all threads, simd, the last pass of 2^31 samples, 2^32 - 1 calls in total, TC_78
+    evaluations=$($EXEC /dev/stdin $OUTPUT_FILE 0 batch simd <<< '0 3.14159265358979323846 0.0000000005' | grep -o 'Evaluations: [0-9]*')
+    assert "$(<$OUTPUT_FILE);$evaluations" "-2.17759;Evaluations: 4294967295"
+else
+    echo "[ INFO ]: slow tests are skipped, run with SLOW_TESTS=1"
+fi
+
+
+
 echo; echo "Total tests passed: ${passed} / ${total_counter}"
 
 # Return success or failure if script is sourced
@@ -7,6 +7,10 @@ import os
 
 SAVE_FOLDER = "data/img"
 
+# Epsilons of the sweeps of tests/perf_tests.bash, in the order they are run
+EPSILON_SWEEP = (1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6)
+PRECISION_SWEEP = (1e-6, 1e-7, 1e-8, 1e-9, 1e-10)
+
 
 @dataclass
 class PlotConfig:
@@ -17,10 +21,17 @@ class PlotConfig:
     chart_type: str
     xscale: str = 'linear'
     yscale: str = 'linear'
+    line_prefix: str = 'Time'
+    # x of the points of a chart, the sweep ending at 1e-5 is assumed if empty
+    xvalues: tuple = ()
+    # names of the sections to draw, all of them if empty
+    sections: tuple = ()
+    # y-axis of a bar chart is fitted to the values, otherwise the bars start at zero
+    yfit: bool = True
 
 
 
-def parse_file(filename: str):
+def parse_file(filename: str, line_prefix: str):
     data = {}
     lines = []
     section = ''
@@ -33,7 +44,7 @@ def parse_file(filename: str):
             section = line.split('[')[1].split(']')[0]
             data.update({section: []})
         else:
-            if (section == ''):
+            if (section == '' or not line.startswith(line_prefix)):
                 continue
             # NOTE: puts all the floats from current line
             data[section] += [float(i) for i in line.split() if i.replace('.','',1).isdigit()]
@@ -44,7 +55,10 @@ def parse_file(filename: str):
 
 def plot_figure_from_file(plot_conf: PlotConfig):
     print(f'Parsing {plot_conf.filename}')
-    data = parse_file(plot_conf.filename)
+    data = parse_file(plot_conf.filename, plot_conf.line_prefix)
+
+    if (plot_conf.sections):
+        data = {name: values for name, values in data.items() if name in plot_conf.sections}
 
     if (plot_conf.chart_type == 'chart'):
         plot_chart(data, plot_conf)
@@ -62,8 +76,7 @@ def plot_figure_from_file(plot_conf: PlotConfig):
 
 def plot_chart(data: dict, plot_conf: PlotConfig):
     num_elements = len(list(data.values())[0])
-    # FIXME: simplified workaround when the x-axis is unknown (always)
-    y = [10 ** i * 0.000001 for i in range(num_elements, 0, -1)]
+    y = plot_conf.xvalues or [10 ** i * 0.000001 for i in range(num_elements, 0, -1)]
     
     fig=plt.figure(label=plot_conf.fig_name)
     ax=fig.add_subplot(111)
@@ -88,7 +101,8 @@ def plot_barchart(data: dict, plot_conf: PlotConfig):
     fig = plt.figure(label=plot_conf.fig_name)
     ax = fig.add_subplot(111)
     ax.bar(keys, values, color=sns.colors.xkcd_rgb['deep sky blue'])
-    ax.set_ylim([min(values) - 0.2, max(values) + 0.2])
+    if (plot_conf.yfit):
+        ax.set_ylim([min(values) - 0.2, max(values) + 0.2])
     ax.set_title(plot_conf.fig_name)
     ax.set_xlabel(plot_conf.xlabel)
     ax.set_ylabel(plot_conf.ylabel)
@@ -124,6 +138,144 @@ def main():
             yscale = 'log',
             xscale = 'log',
             chart_type = 'chart'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_persistent.txt',
+            fig_name = 'Performance from parallel region lifetime',
+            xlabel = 'Epsilon',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            xscale = 'log',
+            chart_type = 'chart',
+            xvalues = EPSILON_SWEEP,
+            sections = ('Per-pass, static', 'Persistent, static', 'Per-pass, guided', 'Persistent, guided')
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_romberg.txt',
+            fig_name = 'Performance from integration engine',
+            xlabel = 'Epsilon',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            xscale = 'log',
+            chart_type = 'chart',
+            xvalues = EPSILON_SWEEP
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_adaptive.txt',
+            fig_name = 'Performance from subdivision',
+            xlabel = 'Epsilon',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            xscale = 'log',
+            chart_type = 'chart',
+            xvalues = EPSILON_SWEEP
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_adaptive.txt',
+            fig_name = 'Evaluations from subdivision',
+            xlabel = 'Epsilon',
+            ylabel = 'Integrand calls',
+            yscale = 'log',
+            xscale = 'log',
+            chart_type = 'chart',
+            xvalues = EPSILON_SWEEP,
+            line_prefix = 'Evaluations'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_gauss_kronrod.txt',
+            fig_name = 'Performance from quadrature rule',
+            xlabel = 'Epsilon',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            xscale = 'log',
+            chart_type = 'chart',
+            xvalues = EPSILON_SWEEP
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_gauss_kronrod.txt',
+            fig_name = 'Evaluations from quadrature rule',
+            xlabel = 'Epsilon',
+            ylabel = 'Integrand calls',
+            yscale = 'log',
+            xscale = 'log',
+            chart_type = 'chart',
+            xvalues = EPSILON_SWEEP,
+            line_prefix = 'Evaluations'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_simd.txt',
+            fig_name = 'Performance from integrand kernel',
+            xlabel = 'Epsilon',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            xscale = 'log',
+            chart_type = 'chart',
+            xvalues = EPSILON_SWEEP
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_integrands.txt',
+            fig_name = 'Performance from integrand',
+            xlabel = 'Epsilon',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            xscale = 'log',
+            chart_type = 'chart',
+            xvalues = EPSILON_SWEEP
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_batch.txt',
+            fig_name = 'Throughput from number of threads',
+            xlabel = 'Threads',
+            ylabel = 'Queries per second',
+            chart_type = 'bar',
+            line_prefix = 'Throughput',
+            yfit = False
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_precision.txt',
+            fig_name = 'Performance from extreme precision',
+            xlabel = 'Epsilon',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            xscale = 'log',
+            chart_type = 'chart',
+            xvalues = PRECISION_SWEEP
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_speculative.txt',
+            fig_name = 'Performance from speculative refinement',
+            xlabel = 'Epsilon',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            xscale = 'log',
+            chart_type = 'chart',
+            xvalues = EPSILON_SWEEP
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_mpi.txt',
+            fig_name = 'Performance from number of ranks',
+            xlabel = 'Ranks',
+            ylabel = 'Time (ms)',
+            chart_type = 'bar',
+            yfit = False
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_mpi.txt',
+            fig_name = 'Speedup from number of ranks',
+            xlabel = 'Ranks',
+            ylabel = 'Speedup',
+            chart_type = 'bar',
+            line_prefix = 'Speedup',
+            yfit = False
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_mpi.txt',
+            fig_name = 'Efficiency from number of ranks',
+            xlabel = 'Ranks',
+            ylabel = 'Efficiency (%)',
+            chart_type = 'bar',
+            line_prefix = 'Efficiency',
+            yfit = False
         )
     ]
 
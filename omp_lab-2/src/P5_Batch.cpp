@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <omp.h>
+
+#include "P5_Batch.h"
+#include "histogram.h"
+
+
+std::vector<std::string> list_batch(std::string path) {
+    std::vector<std::string> names;
+    std::error_code error;
+
+    if (std::filesystem::is_directory(path, error)) {
+        for (const auto &entry: std::filesystem::directory_iterator(path, error))
+            if (entry.path().extension() == ".pgm" && !entry.is_directory(error))
+                names.push_back(entry.path().string());
+
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    std::ifstream fin(path);
+
+    if (!fin.is_open())
+        ::report_failure("Unable to open input file");
+
+    for (std::string line; std::getline(fin, line); ) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty())
+            names.push_back(line);
+    }
+
+    return names;
+}
+
+
+// Loads the image and counts it by the engine, or by the one fitting the team when "auto".
+// Images are counted by the threads of the team, so a failure is not reported here:
+// it sets the error and an empty histogram is returned
+static Image_Hist count_image(const std::string &name, std::string_view engine_name, bool omp_enable,
+                              std::string_view &error) {
+    auto img = try_read_P5_image_from_file(name, error);
+
+    if (!error.empty())
+        return {};
+
+    Image_View view = image_view(img);
+
+    if (img.channels > 1) {
+        error = "Color images are supported by the whole histogram only";
+        return {};
+    }
+
+    // The engines would report 16-bit samples above the max value from this thread
+    if (sample_size(view.max_val) > 1 &&
+        !samples_within(view.data, static_cast<std::size_t>(view.width) * view.height, view.max_val)) {
+        error = "Invalid file format";
+        return {};
+    }
+
+    if (engine_name == "auto")
+        engine_name = ::select_engine(view, omp_enable ? omp_get_max_threads() : 1);
+
+    const Engine &engine = engines.at(engine_name);
+
+    if (!engine.wide && sample_size(view.max_val) > 1) {
+        error = "Engine does not support 16-bit images";
+        return {};
+    }
+
+    return (omp_enable ? engine.omp : engine.no_omp)(view);
+}
+
+
+Batch_Histograms batch_histograms(const std::vector<std::string> &names, std::string_view engine_name,
+                                  bool omp_enable) {
+    Batch_Histograms batch;
+    std::vector<std::size_t> small, large;
+
+    // The size of a file tells the size of the image without reading it
+    for (std::size_t i = 0; i < names.size(); i++) {
+        std::error_code error;
+        std::uintmax_t size = std::filesystem::file_size(names[i], error);
+
+        (!error && size >= BATCH_LARGE_FILE_SIZE ? large : small).push_back(i);
+    }
+
+    batch.names = names;
+    batch.hists.resize(names.size());
+    batch.large = large.size();
+
+    auto time_begin = std::chrono::steady_clock::now();
+
+    // Failures are kept per image and the first one in the order of the names is
+    // reported by the calling thread, once the team is done
+    std::vector<std::string_view> errors(names.size());
+
+    #pragma omp parallel for schedule(dynamic) if(omp_enable)
+    for (std::size_t j = 0; j < small.size(); j++)
+        batch.hists[small[j]] = ::count_image(names[small[j]], engine_name, false, errors[small[j]]);
+
+    for (auto i: large)
+        batch.hists[i] = ::count_image(names[i], engine_name, omp_enable, errors[i]);
+
+    batch.time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - time_begin).count();
+
+    for (const auto &error: errors)
+        if (!error.empty())
+            ::report_failure(error);
+
+    return batch;
+}
+
+
+void save_batch(std::string filename, const Batch_Histograms &batch) {
+    std::ofstream fout(filename, std::ios_base::binary);
+
+    if (!fout.is_open())
+        ::report_failure("Unable to open output file");
+
+    auto write = [&fout](auto value) { fout.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+    std::uint64_t offset = sizeof(std::uint32_t) +
+                           batch.names.size() * (sizeof(std::uint64_t) + 2 * sizeof(std::uint32_t));
+
+    for (const auto &name: batch.names)
+        offset += name.size();
+
+    write(static_cast<std::uint32_t>(batch.names.size()));
+
+    for (std::size_t i = 0; i < batch.names.size(); i++) {
+        write(offset);
+        write(static_cast<std::uint32_t>(batch.hists[i].size()));
+        write(static_cast<std::uint32_t>(batch.names[i].size()));
+        offset += batch.hists[i].size() * sizeof(std::uint32_t);
+    }
+
+    for (const auto &name: batch.names)
+        fout.write(name.data(), name.size());
+
+    for (const auto &hist: batch.hists)
+        fout.write(reinterpret_cast<const char*>(hist.data()), hist.size() * sizeof(hist[0]));
+}
@@ -1,34 +1,233 @@
+#include <algorithm>
 #include <fstream>
+#include <cctype>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "P5_Image.h"
 
 
-P5_Image read_P5_image_from_file(std::string filename) {
-    std::ifstream fin(filename);
-    std::string tmp;
-    P5_Image read_image;
+// Files are read by blocks of this size when they cannot be mapped
+constexpr std::size_t READ_BLOCK_SIZE = 1 << 24;
+
+
+// Maps the whole file into memory, returns nullptr if it is not a regular file.
+// Nothing is read here: the pages are faulted in by the first pass over the
+// pixels, and the kernel is told to read ahead of it
+static std::shared_ptr<const std::uint8_t> map_file(const std::string &filename, std::size_t &size,
+                                                    std::string_view &error) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat file_stat;
+
+    if (fd == -1) {
+        error = "Unable to open input file";
+        return nullptr;
+    }
+
+    if (fstat(fd, &file_stat) == -1 || !S_ISREG(file_stat.st_mode) || file_stat.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    size = static_cast<std::size_t>(file_stat.st_size);
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+        return nullptr;
 
-    if (!fin.is_open())
-        ::report_failure("Unable to open input file");
-    
-    fin >> tmp;
-    if (tmp.compare("P5") != 0)
-        ::report_failure("Invalid file format");
-    
-    fin >> read_image.width >> read_image.height >> read_image.max_val >> std::ws;
+    // Only a hint, the mapping works without it
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    return std::shared_ptr<const std::uint8_t>(static_cast<const std::uint8_t*>(mapping),
+                                               [size](const std::uint8_t *ptr) { munmap(const_cast<std::uint8_t*>(ptr), size); });
+}
 
-    if (read_image.max_val > 255)
-        ::report_failure("Invalid max value");
 
-    std::uint8_t data_byte;
-    fin.unsetf(std::ios_base::skipws);
-    read_image.data.reserve(read_image.width * read_image.height);
+// Reads the whole file (a pipe as well) by large blocks
+static std::shared_ptr<const std::uint8_t> read_file(const std::string &filename, std::size_t &size,
+                                                     std::string_view &error) {
+    std::ifstream fin(filename, std::ios_base::binary);
+    auto buffer = std::make_shared<std::vector<std::uint8_t>>();
 
-    for (int i = 0; i < read_image.width * read_image.height; i++) {
-        fin >> data_byte;
-        read_image.data.emplace_back(data_byte);
+    if (!fin.is_open()) {
+        error = "Unable to open input file";
+        return nullptr;
     }
 
+    size = 0;
+    do {
+        buffer->resize(size + READ_BLOCK_SIZE);
+        fin.read(reinterpret_cast<char*>(buffer->data() + size), READ_BLOCK_SIZE);
+        size += static_cast<std::size_t>(fin.gcount());
+    } while (fin);
+
+    buffer->resize(size);
     fin.close();
-    
+
+    return std::shared_ptr<const std::uint8_t>(buffer, buffer->data());
+}
+
+
+// Reads a decimal value of the header preceded by whitespaces and comments
+static bool parse_header_value(const std::uint8_t *&pos, const std::uint8_t *end, unsigned int &value) {
+    while (pos < end && (std::isspace(*pos) || *pos == '#')) {
+        if (*pos == '#') {
+            while (pos < end && *pos != '\n')
+                pos++;
+        } else {
+            pos++;
+        }
+    }
+
+    if (pos == end || !std::isdigit(*pos))
+        return false;
+
+    std::uint64_t parsed = 0;
+    while (pos < end && std::isdigit(*pos) && parsed <= UINT32_MAX)
+        parsed = parsed * 10 + (*pos++ - '0');
+
+    value = static_cast<unsigned int>(parsed);
+    return parsed <= UINT32_MAX;
+}
+
+
+bool samples_within(const std::uint8_t *data, std::size_t samples, unsigned int max_val) {
+    // Every value of the sample size is within 255 and 65535, nothing to read then
+    if (max_val == 255 || max_val == 65535)
+        return true;
+
+    // The largest sample is reduced without branches, so the loops are vectorized
+    unsigned int largest = 0;
+
+    if (sample_size(max_val) == 1) {
+        std::uint8_t largest_byte = 0;
+
+        for (std::size_t i = 0; i < samples; ++i)
+            largest_byte = std::max(largest_byte, data[i]);
+        largest = largest_byte;
+    } else {
+        for (std::size_t i = 0; i < samples; ++i)
+            largest = std::max(largest, sample_value<2>(data, i));
+    }
+
+    return largest <= max_val;
+}
+
+
+std::size_t try_parse_P5_header(const std::uint8_t *data, std::size_t size, P5_Image &img, std::string_view &error) {
+    const std::uint8_t *pos = data;
+    const std::uint8_t *end = data + size;
+
+    if (size < 2 || pos[0] != 'P' || (pos[1] != '5' && pos[1] != '6')) {
+        error = "Invalid file format";
+        return 0;
+    }
+    img.channels = pos[1] == '6' ? 3 : 1;
+    pos += 2;
+
+    if (!parse_header_value(pos, end, img.width) ||
+        !parse_header_value(pos, end, img.height) ||
+        !parse_header_value(pos, end, img.max_val) ||
+        pos == end || !std::isspace(*pos)) {
+        error = "Invalid file format";
+        return 0;
+    }
+    pos++;      // Single whitespace separates the header from the pixels
+
+    if (img.max_val > 65535) {
+        error = "Invalid max value";
+        return 0;
+    }
+
+    return static_cast<std::size_t>(pos - data);
+}
+
+
+std::size_t parse_P5_header(const std::uint8_t *data, std::size_t size, P5_Image &img) {
+    std::string_view error;
+    std::size_t header_size = try_parse_P5_header(data, size, img, error);
+
+    if (!error.empty())
+        ::report_failure(error);
+
+    return header_size;
+}
+
+
+P5_Image try_read_P5_image_from_file(std::string filename, std::string_view &error) {
+    std::size_t size = 0;
+    P5_Image read_image;
+
+    read_image.storage = map_file(filename, size, error);
+    if (!read_image.storage && error.empty())
+        read_image.storage = read_file(filename, size, error);
+    if (!error.empty())
+        return {};
+
+    std::size_t header_size = try_parse_P5_header(read_image.storage.get(), size, read_image, error);
+    if (!error.empty())
+        return {};
+
+    if ((size - header_size) / (sample_size(read_image.max_val) * read_image.channels) <
+        static_cast<std::size_t>(read_image.width) * read_image.height) {
+        error = "Unexpected end of file";
+        return {};
+    }
+
+    read_image.data = read_image.storage.get() + header_size;
+
+    // 16-bit samples are left to the pass, which counts them, so a huge image is
+    // not read twice (8-bit ones are read only if the max value is below 255)
+    if (sample_size(read_image.max_val) == 1 &&
+        !samples_within(read_image.data, static_cast<std::size_t>(read_image.width) * read_image.height * read_image.channels,
+                        read_image.max_val)) {
+        error = "Invalid file format";
+        return {};
+    }
+
+    return read_image;
+}
+
+
+P5_Image read_P5_image_from_file(std::string filename) {
+    std::string_view error;
+    P5_Image read_image = try_read_P5_image_from_file(filename, error);
+
+    if (!error.empty())
+        ::report_failure(error);
+
     return read_image;
 }
+
+
+void write_P5_image_to_file(std::string filename, const std::vector<std::uint8_t> &pixels,
+                            unsigned int width, unsigned int height, unsigned int max_val) {
+    std::ofstream fout(filename, std::ios_base::binary);
+
+    if (!fout.is_open())
+        ::report_failure("Unable to open output file");
+
+    fout << "P5\n" << width << ' ' << height << '\n' << max_val << '\n';
+    fout.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+}
+
+
+Image_View image_view(const P5_Image &img) {
+    return {img.data, img.width, img.height, static_cast<std::size_t>(img.width) * sample_size(img.max_val) * img.channels,
+            img.max_val, img.channels};
+}
+
+
+Image_View image_view(const std::vector<std::uint8_t> &pixels, unsigned int width, unsigned int height,
+                      unsigned int max_val) {
+    return {pixels.data(), width, height, static_cast<std::size_t>(width) * sample_size(max_val), max_val};
+}
+
+
+Image_View image_view(const Image_View &view, unsigned int x, unsigned int y,
+                      unsigned int width, unsigned int height) {
+    return {view.data + y * view.stride + static_cast<std::size_t>(x) * sample_size(view.max_val) * view.channels,
+            width, height, view.stride, view.max_val, view.channels};
+}
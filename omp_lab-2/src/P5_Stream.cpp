@@ -0,0 +1,388 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <omp.h>
+
+#include "P5_Stream.h"
+#include "histogram.h"
+#include "hist_delta.h"
+
+
+// Header has to fit into the first read of the file
+constexpr std::size_t STREAM_HEADER_SIZE = 1 << 16;
+
+
+// Chunk (or frame) k is in the buffer k % STREAM_BUFFERS. The reader fills a buffer
+// while less than STREAM_BUFFERS chunks are waiting, the team takes them in order
+typedef struct {
+    std::vector<std::uint8_t> buffers[STREAM_BUFFERS];
+    std::size_t sizes[STREAM_BUFFERS];
+    P5_Image headers[STREAM_BUFFERS];                           // frames only
+    std::chrono::steady_clock::time_point arrivals[STREAM_BUFFERS]; // frames only
+    std::size_t filled = 0;         // chunks read
+    std::size_t counted = 0;        // chunks released by the team
+    bool finished = false;          // no more chunks will be read
+    bool truncated = false;         // the file ended before the last pixel
+    std::string_view error;         // failure of the reader, reported by the main thread
+    bool stopped = false;           // the team failed, the reader leaves before its next chunk
+    std::mutex mutex;
+    std::condition_variable changed;
+} Stream_Ring;
+
+
+// Reads the rest of the pixels by chunks, the leftover of the header read comes first
+static void read_chunks(std::ifstream &fin, std::vector<std::uint8_t> leftover,
+                        std::size_t payload, std::size_t chunk_size, unsigned int max_val, Stream_Ring &ring) {
+    std::size_t position = 0;   // bytes of the payload read
+
+    while (position < payload) {
+        std::size_t slot = ring.filled % STREAM_BUFFERS;
+        std::size_t size = std::min(chunk_size, payload - position);
+
+        {
+            std::unique_lock<std::mutex> lock(ring.mutex);
+            ring.changed.wait(lock, [&] { return ring.stopped || ring.filled - ring.counted < STREAM_BUFFERS; });
+
+            if (ring.stopped)
+                break;
+        }
+
+        std::vector<std::uint8_t> &buffer = ring.buffers[slot];
+        std::size_t from_leftover = std::min(size, leftover.size());
+
+        std::copy(leftover.begin(), leftover.begin() + from_leftover, buffer.begin());
+        leftover.erase(leftover.begin(), leftover.begin() + from_leftover);
+        fin.read(reinterpret_cast<char*>(buffer.data() + from_leftover), size - from_leftover);
+
+        std::size_t got = from_leftover + (from_leftover < size ? static_cast<std::size_t>(fin.gcount()) : 0);
+        std::lock_guard<std::mutex> lock(ring.mutex);
+
+        if (got < size) {
+            ring.truncated = true;
+            break;
+        }
+
+        if (!samples_within(buffer.data(), size / sample_size(max_val), max_val)) {
+            ring.error = "Invalid file format";
+            break;
+        }
+
+        ring.sizes[slot] = size;
+        ring.filled++;
+        position += size;
+        ring.changed.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(ring.mutex);
+    ring.finished = true;
+    ring.changed.notify_all();
+}
+
+
+Stream_Histogram stream_histogram(std::string filename, std::size_t chunk_size,
+                                  std::string_view engine_name, bool omp_enable) {
+    std::ifstream fin(filename, std::ios_base::binary);
+    std::vector<std::uint8_t> head(STREAM_HEADER_SIZE);
+    P5_Image img;
+
+    if (!fin.is_open())
+        ::report_failure("Unable to open input file");
+
+    auto time_begin = std::chrono::steady_clock::now();
+
+    fin.read(reinterpret_cast<char*>(head.data()), head.size());
+    head.resize(static_cast<std::size_t>(fin.gcount()));
+
+    std::size_t header_size = parse_P5_header(head.data(), head.size(), img);
+
+    if (img.channels > 1)
+        ::report_failure("Color images are supported by the whole histogram only");
+
+    std::size_t row_size = static_cast<std::size_t>(img.width) * sample_size(img.max_val);
+    std::size_t payload = row_size * img.height;
+    std::size_t chunk_rows = std::max<std::size_t>(chunk_size / std::max<std::size_t>(row_size, 1), 1);
+
+    chunk_rows = std::min<std::size_t>(chunk_rows, std::max(img.height, 1u));
+
+    Stream_Histogram result;
+    Stream_Ring ring;
+
+    result.hist.assign(img.max_val + 1, 0);
+    result.chunks = 0;
+    result.wait_time = 0;
+    result.buffer_size = STREAM_BUFFERS * chunk_rows * row_size;
+
+    // Every chunk but the last one has the same size, so does the choice of the engine
+    Image_View first = {nullptr, img.width, static_cast<unsigned int>(chunk_rows), row_size, img.max_val};
+
+    if (engine_name == "auto")
+        engine_name = ::select_engine(first, omp_enable ? omp_get_max_threads() : 1);
+    result.engine_name = engine_name;
+
+    const Engine &engine = engines.at(engine_name);
+    histogram_t count = omp_enable ? engine.omp : engine.no_omp;
+
+    if (!engine.wide && sample_size(img.max_val) > 1)
+        ::report_failure("Engine does not support 16-bit images");
+
+    for (auto &buffer: ring.buffers)
+        buffer.resize(chunk_rows * row_size);
+
+    std::vector<std::uint8_t> leftover(head.begin() + std::min(header_size, head.size()), head.end());
+    std::thread reader(read_chunks, std::ref(fin), std::move(leftover), payload, chunk_rows * row_size, img.max_val,
+                       std::ref(ring));
+
+    for (std::size_t chunk = 0; ; chunk++) {
+        std::size_t slot = chunk % STREAM_BUFFERS;
+        auto wait_begin = std::chrono::steady_clock::now();
+
+        {
+            std::unique_lock<std::mutex> lock(ring.mutex);
+            ring.changed.wait(lock, [&] { return ring.filled > chunk || ring.finished; });
+
+            if (ring.filled <= chunk)
+                break;
+        }
+
+        result.wait_time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wait_begin).count();
+
+        Image_View view = {ring.buffers[slot].data(), img.width, static_cast<unsigned int>(ring.sizes[slot] / row_size),
+                           row_size, img.max_val};
+        Image_Hist hist = count(view);
+
+        for (std::size_t i = 0; i < hist.size(); ++i)
+            result.hist[i] += hist[i];
+
+        std::lock_guard<std::mutex> lock(ring.mutex);
+        ring.counted++;
+        result.chunks++;
+        ring.changed.notify_all();
+    }
+
+    reader.join();
+    result.time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - time_begin).count();
+
+    if (!ring.error.empty())
+        ::report_failure(ring.error);
+
+    if (ring.truncated)
+        ::report_failure("Unexpected end of file");
+
+    return result;
+}
+
+
+// Reads the frames one after another. The bytes read ahead of the pixels of a
+// frame are kept pending, so the header of the next one is parsed in memory
+static void read_frames(std::ifstream &fin, double fps, Stream_Ring &ring) {
+    std::vector<std::uint8_t> pending;
+    std::chrono::duration<double> period(fps > 0 ? 1 / fps : 0);
+    auto first_arrival = std::chrono::steady_clock::now();
+
+    for (std::size_t frame = 0; ; frame++) {
+        std::size_t slot = frame % STREAM_BUFFERS;
+
+        {
+            std::unique_lock<std::mutex> lock(ring.mutex);
+            ring.changed.wait(lock, [&] { return ring.stopped || ring.filled - ring.counted < STREAM_BUFFERS; });
+
+            if (ring.stopped)
+                break;
+        }
+
+        // Replayed frames arrive on schedule, even if the ring was full at that moment
+        auto arrival = first_arrival + std::chrono::duration_cast<std::chrono::steady_clock::duration>(period * frame);
+
+        if (fps > 0)
+            std::this_thread::sleep_until(arrival);
+        else
+            arrival = std::chrono::steady_clock::now();
+
+        // Frames may be separated by whitespaces, the header has to fit into the pending bytes
+        std::size_t skipped = 0;
+
+        do {
+            std::size_t size = pending.size();
+
+            if (size < STREAM_HEADER_SIZE && fin) {
+                pending.resize(STREAM_HEADER_SIZE);
+                fin.read(reinterpret_cast<char*>(pending.data() + size), STREAM_HEADER_SIZE - size);
+                pending.resize(size + static_cast<std::size_t>(fin.gcount()));
+            }
+
+            skipped = 0;
+            while (skipped < pending.size() && std::isspace(pending[skipped]))
+                skipped++;
+            pending.erase(pending.begin(), pending.begin() + skipped);
+        } while (skipped > 0 && fin);
+
+        if (pending.empty())
+            break;
+
+        // The reader does not exit on a failure, the team may still be counting
+        P5_Image &header = ring.headers[slot];
+        std::string_view error;
+        std::size_t header_size = try_parse_P5_header(pending.data(), pending.size(), header, error);
+
+        if (error.empty() && header.channels > 1)
+            error = "Color images are supported by the whole histogram only";
+
+        if (!error.empty()) {
+            std::lock_guard<std::mutex> lock(ring.mutex);
+            ring.error = error;
+            break;
+        }
+
+        std::size_t size = static_cast<std::size_t>(header.width) * header.height * sample_size(header.max_val);
+        std::size_t from_pending = std::min(size, pending.size() - header_size);
+        std::vector<std::uint8_t> &buffer = ring.buffers[slot];
+
+        buffer.resize(size);
+        std::copy(pending.begin() + header_size, pending.begin() + header_size + from_pending, buffer.begin());
+        pending.erase(pending.begin(), pending.begin() + header_size + from_pending);
+        fin.read(reinterpret_cast<char*>(buffer.data() + from_pending), size - from_pending);
+
+        std::size_t got = from_pending + (from_pending < size ? static_cast<std::size_t>(fin.gcount()) : 0);
+        std::lock_guard<std::mutex> lock(ring.mutex);
+
+        if (got < size) {
+            ring.truncated = true;
+            break;
+        }
+
+        if (!samples_within(buffer.data(), size / sample_size(header.max_val), header.max_val)) {
+            ring.error = "Invalid file format";
+            break;
+        }
+
+        ring.sizes[slot] = size;
+        ring.arrivals[slot] = arrival;
+        ring.filled++;
+        ring.changed.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(ring.mutex);
+    ring.finished = true;
+    ring.changed.notify_all();
+}
+
+
+Frame_Stream stream_frames(std::string filename, std::ostream &out, double fps,
+                           std::string_view engine_name, bool omp_enable, bool delta,
+                           const std::vector<std::vector<Image_Rect>> &dirty) {
+    std::ifstream fin(filename, std::ios_base::binary);
+
+    if (!fin.is_open())
+        ::report_failure("Unable to open input file");
+
+    Frame_Stream result;
+    Stream_Ring ring;
+    int threads = omp_enable ? omp_get_max_threads() : 1;
+
+    result.engine_name = engine_name;
+    result.missed = 0;
+    result.updated_pixels = 0;
+    result.changed_pixels = 0;
+
+    Image_Hist hist;
+    Image_View previous = {nullptr, 0, 0, 0, 0};
+
+    std::string_view failure;       // of the team
+
+    auto time_begin = std::chrono::steady_clock::now();
+    std::thread reader(read_frames, std::ref(fin), fps, std::ref(ring));
+
+    for (std::size_t frame = 0; ; frame++) {
+        std::size_t slot = frame % STREAM_BUFFERS;
+
+        {
+            std::unique_lock<std::mutex> lock(ring.mutex);
+            ring.changed.wait(lock, [&] { return ring.filled > frame || ring.finished; });
+
+            if (ring.filled <= frame)
+                break;
+        }
+
+        // Frames of a dump may differ in size, so "auto" is chosen for every one
+        const P5_Image &header = ring.headers[slot];
+        Image_View view = image_view(ring.buffers[slot], header.width, header.height, header.max_val);
+        std::string_view name = engine_name == "auto" ? ::select_engine(view, threads) : engine_name;
+        const Engine &engine = engines.at(name);
+
+        // The reader is stopped and joined before the failure is reported
+        if (!engine.wide && sample_size(view.max_val) > 1) {
+            std::lock_guard<std::mutex> lock(ring.mutex);
+            failure = "Engine does not support 16-bit images";
+            ring.stopped = true;
+            ring.changed.notify_all();
+            break;
+        }
+
+        // The previous frame is still in its buffer, so a frame of the same shape
+        // updates its histogram instead of counting every pixel
+        if (delta && previous.data && previous.width == view.width && previous.height == view.height &&
+            previous.max_val == view.max_val) {
+            result.changed_pixels += frame <= dirty.size() ? ::update_histogram(hist, previous, view, dirty[frame - 1], omp_enable)
+                                                           : ::update_histogram(hist, previous, view, omp_enable);
+            result.updated_pixels += static_cast<std::size_t>(view.width) * view.height;
+        } else {
+            hist = (omp_enable ? engine.omp : engine.no_omp)(view);
+        }
+
+        previous = view;
+        std::uint32_t bins = static_cast<std::uint32_t>(hist.size());
+
+        out.write(reinterpret_cast<const char*>(&bins), sizeof(bins));
+        out.write(reinterpret_cast<const char*>(hist.data()), hist.size() * sizeof(hist[0]));
+
+        double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - ring.arrivals[slot]).count();
+
+        result.latencies.push_back(latency);
+        if (fps > 0 && latency > 1000 / fps)
+            result.missed++;
+        if (frame == 0)
+            result.engine_name = name;
+
+        // With delta updates the buffer of a frame is released after the next frame
+        std::lock_guard<std::mutex> lock(ring.mutex);
+        ring.counted = delta ? frame : frame + 1;
+        ring.changed.notify_all();
+    }
+
+    reader.join();
+    result.time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - time_begin).count();
+    result.frames = result.latencies.size();
+
+    if (!failure.empty())
+        ::report_failure(failure);
+
+    if (!ring.error.empty())
+        ::report_failure(ring.error);
+
+    if (ring.truncated)
+        ::report_failure("Unexpected end of file");
+
+    return result;
+}
+
+
+double latency_percentile(const Frame_Stream &frames, double p) {
+    if (frames.latencies.empty())
+        return 0;
+
+    // Nearest rank: the smallest latency, which is not exceeded by p percent of the frames
+    std::vector<double> sorted = frames.latencies;
+    std::size_t rank = static_cast<std::size_t>(std::ceil(p / 100 * sorted.size()));
+
+    rank = std::min(std::max<std::size_t>(rank, 1), sorted.size());
+    std::nth_element(sorted.begin(), sorted.begin() + (rank - 1), sorted.end());
+
+    return sorted[rank - 1];
+}
@@ -0,0 +1,74 @@
+#include <cstdlib>
+#include <string_view>
+#include <immintrin.h>
+#include "diff_simd.h"
+
+
+static std::size_t mismatch_scalar(const std::uint8_t *a, const std::uint8_t *b, std::size_t n) {
+    std::size_t i = 0;
+
+    while (i < n && a[i] == b[i])
+        ++i;
+
+    return i;
+}
+
+
+// 32 bytes per compare, the lowest bit of the inverted mask is the first mismatch
+__attribute__((target("avx2")))
+static std::size_t mismatch_avx2(const std::uint8_t *a, const std::uint8_t *b, std::size_t n) {
+    std::size_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i block_a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i block_b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        unsigned int equal = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block_a, block_b)));
+
+        if (equal != 0xFFFFFFFFu)
+            return i + __builtin_ctz(~equal);
+    }
+
+    return i + mismatch_scalar(a + i, b + i, n - i);
+}
+
+
+// 64 bytes per compare straight into a mask of the differing bytes
+__attribute__((target("avx512f,avx512bw")))
+static std::size_t mismatch_avx512(const std::uint8_t *a, const std::uint8_t *b, std::size_t n) {
+    std::size_t i = 0;
+
+    for (; i + 64 <= n; i += 64) {
+        __m512i block_a = _mm512_loadu_si512(a + i);
+        __m512i block_b = _mm512_loadu_si512(b + i);
+        __mmask64 differ = _mm512_cmpneq_epi8_mask(block_a, block_b);
+
+        if (differ)
+            return i + __builtin_ctzll(differ);
+    }
+
+    return i + mismatch_scalar(a + i, b + i, n - i);
+}
+
+
+const Diff_Kernel DIFF_KERNEL_SCALAR = {"scalar", mismatch_scalar};
+const Diff_Kernel DIFF_KERNEL_AVX2 = {"avx2", mismatch_avx2};
+const Diff_Kernel DIFF_KERNEL_AVX512 = {"avx512", mismatch_avx512};
+
+
+const Diff_Kernel &diff_kernel() {
+    static const Diff_Kernel &kernel = []() -> const Diff_Kernel & {
+        const char *forced = std::getenv("DIFF_KERNEL");
+        std::string_view name = forced ? forced : "";
+
+        if (name == "scalar")
+            return DIFF_KERNEL_SCALAR;
+        if ((name.empty() || name == "avx512") && __builtin_cpu_supports("avx512bw"))
+            return DIFF_KERNEL_AVX512;
+        if ((name.empty() || name == "avx2") && __builtin_cpu_supports("avx2"))
+            return DIFF_KERNEL_AVX2;
+
+        return DIFF_KERNEL_SCALAR;
+    }();
+
+    return kernel;
+}
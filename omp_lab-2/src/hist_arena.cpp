@@ -0,0 +1,37 @@
+#include <cstring>
+#include "hist_arena.h"
+#include "utilities.h"
+
+
+void Hist_Arena::reserve(std::size_t tables_num, std::size_t table_size) {
+    constexpr std::size_t line = CACHE_LINE / sizeof(std::uint32_t);
+
+    size = table_size;
+    stride = (table_size + line - 1) / line * line;
+
+    if (tables_num * stride <= capacity)
+        return;
+
+    // Large blocks are mapped by the allocator without touching the pages
+    memory.reset(static_cast<std::uint32_t*>(std::aligned_alloc(CACHE_LINE, tables_num * stride * sizeof(std::uint32_t))));
+
+    if (!memory)
+        ::report_failure("Unable to allocate histogram tables");
+
+    capacity = tables_num * stride;
+}
+
+
+std::uint32_t *Hist_Arena::claim(std::size_t index) {
+    std::uint32_t *table = memory.get() + index * stride;
+
+    std::memset(table, 0, size * sizeof(std::uint32_t));
+    return table;
+}
+
+
+Hist_Arena &caller_arena() {
+    static thread_local Hist_Arena arena;
+
+    return arena;
+}
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <omp.h>
+
+#include "hist_delta.h"
+#include "hist_arena.h"
+#include "diff_simd.h"
+#include "utilities.h"
+
+
+typedef struct {
+    const std::uint8_t *previous, *current;
+    std::size_t size;       // bytes
+} Row_Pair;
+
+typedef struct {
+    unsigned int row, begin, end;   // pixels [begin, end) of the row
+} Row_Span;
+
+
+// Counts the pixels of the row, which differ, into the table of changes: the
+// previous value is decremented, the current one incremented (modulo 2^32, the
+// sum of the tables is the change of the histogram). The kernel skips the equal
+// bytes, a run of changed pixels is taken one by one without calling it again
+template <unsigned int depth>
+static std::size_t update_row(std::uint32_t *table, const Row_Pair &row, diff_kernel_t mismatch) {
+    std::size_t changed = 0;
+    std::size_t pixels = row.size / depth;
+    std::size_t pixel = mismatch(row.previous, row.current, row.size) / depth;
+
+    while (pixel < pixels) {
+        unsigned int old_value = sample_value<depth>(row.previous, pixel);
+        unsigned int new_value = sample_value<depth>(row.current, pixel);
+
+        if (old_value == new_value) {
+            std::size_t next = (pixel + 1) * depth;
+            pixel = next < row.size ? (next + mismatch(row.previous + next, row.current + next, row.size - next)) / depth
+                                    : pixels;
+            continue;
+        }
+
+        --table[old_value];
+        ++table[new_value];
+        ++changed;
+        ++pixel;
+    }
+
+    return changed;
+}
+
+
+std::size_t update_histogram(Image_Hist &hist, Image_View previous, Image_View current,
+                             const std::vector<Image_Rect> &dirty, bool omp_enable) {
+    unsigned int depth = sample_size(current.max_val);
+    diff_kernel_t mismatch = diff_kernel().mismatch;
+    std::vector<Row_Pair> rows;
+    std::size_t changed = 0;
+
+    // Spans of the rows covered by the rectangles clipped to the frames, the ones
+    // of a row, which overlap or touch, are merged, so every pixel is compared once
+    std::vector<Row_Span> spans;
+
+    for (const auto &rect: dirty) {
+        unsigned int x = std::min(rect.x, current.width), y = std::min(rect.y, current.height);
+        unsigned int width = std::min(rect.width, current.width - x), height = std::min(rect.height, current.height - y);
+
+        // Empty or outside of the frames
+        if (width == 0 || height == 0)
+            continue;
+
+        for (unsigned int row = y; row < y + height; ++row)
+            spans.push_back({row, x, x + width});
+    }
+
+    std::sort(spans.begin(), spans.end(), [](const Row_Span &a, const Row_Span &b) {
+        return a.row != b.row ? a.row < b.row : a.begin < b.begin;
+    });
+
+    for (std::size_t i = 0; i < spans.size(); ) {
+        Row_Span span = spans[i];
+
+        for (++i; i < spans.size() && spans[i].row == span.row && spans[i].begin <= span.end; ++i)
+            span.end = std::max(span.end, spans[i].end);
+
+        std::size_t offset = static_cast<std::size_t>(span.begin) * depth;
+        rows.push_back({previous.data + span.row * previous.stride + offset,
+                        current.data + span.row * current.stride + offset,
+                        static_cast<std::size_t>(span.end - span.begin) * depth});
+    }
+
+    // Tables of changes
+    Hist_Arena &arena = ::caller_arena();
+    int team_size = 1;
+
+    arena.reserve(omp_enable ? omp_get_max_threads() : 1, hist.size());
+
+    #pragma omp parallel reduction(+: changed) if(omp_enable)
+    {
+        std::uint32_t *table = arena.claim(omp_get_thread_num());
+
+        #pragma omp master
+        team_size = omp_get_num_threads();
+
+        #pragma omp for schedule(static)
+        for (std::size_t r = 0; r < rows.size(); ++r)
+            changed += depth == 1 ? ::update_row<1>(table, rows[r], mismatch)
+                                  : ::update_row<2>(table, rows[r], mismatch);
+
+        // Every thread adds its share of the bins of all the tables
+        #pragma omp for schedule(static)
+        for (std::size_t v = 0; v < hist.size(); ++v) {
+            for (int t = 0; t < team_size; ++t)
+                hist[v] += arena.table(t)[v];
+        }
+    }
+
+    return changed;
+}
+
+
+std::size_t update_histogram(Image_Hist &hist, Image_View previous, Image_View current, bool omp_enable) {
+    return ::update_histogram(hist, previous, current, {{0, 0, current.width, current.height}}, omp_enable);
+}
+
+
+std::vector<std::vector<Image_Rect>> read_dirty_list(std::string filename) {
+    std::ifstream fin(filename);
+
+    if (!fin.is_open())
+        ::report_failure("Unable to open dirty list");
+
+    std::vector<std::vector<Image_Rect>> dirty;
+
+    for (std::string line; std::getline(fin, line); ) {
+        std::istringstream words(line);
+
+        dirty.emplace_back();
+        for (std::string word; words >> word; ) {
+            Image_Rect rect;
+            char tail;
+
+            if (std::sscanf(word.c_str(), "%u,%u,%u,%u%c", &rect.x, &rect.y, &rect.width, &rect.height, &tail) != 4)
+                ::report_failure("Invalid dirty rectangle");
+            dirty.back().push_back(rect);
+        }
+    }
+
+    return dirty;
+}
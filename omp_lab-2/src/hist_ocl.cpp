@@ -0,0 +1,125 @@
+#ifdef USE_OPENCL
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "ezocl_core.h"
+#include "hist_ocl.h"
+
+
+// Work-items of a group, and groups at most: the partial histograms of the groups
+// are summed by the second kernel, so their number is kept small
+constexpr std::size_t OCL_GROUP_SIZE = 256;
+constexpr std::size_t OCL_MAX_GROUPS = 128;
+// Partials of 16-bit samples are 256 KiB per group, so fewer groups count them
+constexpr std::size_t OCL_MAX_GLOBAL_GROUPS = 16;
+// Smaller images take fewer groups, every work-item counts at least this many samples
+constexpr std::size_t OCL_MIN_ITEM_SAMPLES = 64;
+// Counters of the tables of a group, 16 KiB is half of the local memory guaranteed
+// by OpenCL 1.2. The tables of 8-bit samples are copied up to OCL_MAX_COPIES times
+constexpr std::size_t OCL_LOCAL_COUNTERS = 4096;
+constexpr std::size_t OCL_MAX_COPIES = 8;
+
+
+Ocl_Histogram compute_histogram_ocl(Image_View img) {
+    unsigned depth = sample_size(img.max_val);
+    // 16-bit samples above the max value are counted into a bin of their own
+    std::size_t bins = img.max_val + (depth > 1 ? 2 : 1);
+    std::size_t row_size = static_cast<std::size_t>(img.width) * depth;
+    std::size_t pixels = static_cast<std::size_t>(img.width) * img.height;
+    Ocl_Histogram result = {Image_Hist(bins, 0), "", 0, 0};
+
+    if (pixels == 0) {
+        result.hist.resize(img.max_val + 1);
+        return result;
+    }
+
+    // Samples are indexed by 32-bit integers on the device
+    if (pixels * depth > UINT32_MAX)
+        ::report_failure("Image is too large for the OpenCL engine");
+
+    // Rows of a region are not adjacent, the device takes a contiguous buffer
+    std::vector<std::uint8_t> packed;
+    const std::uint8_t *data = img.data;
+
+    if (img.stride != row_size) {
+        packed.resize(row_size * img.height);
+        for (unsigned row = 0; row < img.height; ++row)
+            std::copy(img.data + row * img.stride, img.data + row * img.stride + row_size, packed.data() + row * row_size);
+        data = packed.data();
+    }
+
+    std::size_t groups = std::clamp<std::size_t>(pixels / (OCL_GROUP_SIZE * OCL_MIN_ITEM_SAMPLES), 1, OCL_MAX_GROUPS);
+    std::size_t copies = std::clamp<std::size_t>(OCL_LOCAL_COUNTERS / bins, 1, OCL_MAX_COPIES);
+    bool local_table = bins * copies <= OCL_LOCAL_COUNTERS;
+
+    if (!local_table)
+        groups = std::min(groups, OCL_MAX_GLOBAL_GROUPS);
+
+    cl_uint size = static_cast<cl_uint>(pixels);
+    cl_uint groups_num = static_cast<cl_uint>(groups);
+    std::vector<cl_uint> partials(groups * bins);
+
+    std::string build_options = "-cl-std=CL1.2 -DSAMPLE_SIZE=" + std::to_string(depth) +
+                                " -DBINS=" + std::to_string(bins) +
+                                " -DCOPIES=" + std::to_string(copies) +
+                                " -DLOCAL_TABLE=" + std::to_string(local_table ? 1 : 0);
+
+    const char *device_env = std::getenv("OCL_DEVICE");
+    std::size_t device_number = device_env ? std::strtoul(device_env, nullptr, 10) : 0;
+
+    try {
+        auto devices = ezocl::DeviceManager::getDevices();
+
+        if (devices.empty()) throw std::runtime_error("No devices found");
+        if (device_number > devices.size() - 1) device_number = 0;
+
+        auto data_buff = std::make_shared<ezocl::Buffer>(const_cast<std::uint8_t*>(data), pixels * depth,
+                                                         ezocl::BufferType::IN_BUFFER);
+        auto size_buff = std::make_shared<ezocl::Buffer>(&size, sizeof(cl_uint), ezocl::BufferType::IN_SCALAR);
+        // Partials are zeroed by the first kernel, so they are not written to the device
+        auto partials_buff = std::make_shared<ezocl::Buffer>(partials.data(), sizeof(cl_uint) * partials.size(),
+                                                             ezocl::BufferType::OUT_BUFFER);
+        auto groups_buff = std::make_shared<ezocl::Buffer>(&groups_num, sizeof(cl_uint), ezocl::BufferType::IN_SCALAR);
+        auto hist_buff = std::make_shared<ezocl::Buffer>(result.hist.data(), sizeof(cl_uint) * bins,
+                                                         ezocl::BufferType::OUT_BUFFER);
+
+        ezocl::Kernel count_kernel {
+            "countHistogram",
+            {groups * OCL_GROUP_SIZE},
+            {OCL_GROUP_SIZE},
+            data_buff, size_buff, partials_buff
+        };
+
+        ezocl::Kernel merge_kernel {
+            "mergeHistogram",
+            ezocl::makeGlobalNDRange({OCL_GROUP_SIZE}, bins),
+            {OCL_GROUP_SIZE},
+            partials_buff, groups_buff, hist_buff
+        };
+
+        ezocl::Program program(OCL_KERNEL_FILE, devices[device_number], count_kernel, merge_kernel);
+        program.execute(build_options);
+
+        // Total time of a kernel is its execution and the transfers of its arguments to the
+        // device, the pixels go with the first one. The results are read back after ezocl
+        // has taken the times, so the totals do not include them
+        auto kernel_time_ns = program.getKernelExecutionTime();
+        auto total_time_ns = program.getTotalKernelTime();
+
+        result.kernel_time = static_cast<double>(kernel_time_ns[0] + kernel_time_ns[1]) / 1000000.0;
+        result.total_time = static_cast<double>(total_time_ns[0] + total_time_ns[1]) / 1000000.0;
+        // The name is stored by ezocl with its terminating zero
+        result.device_name = devices[device_number].get_device_name().c_str();
+    } catch (const std::exception &e) {
+        ::report_failure(e.what());
+    }
+
+    if (depth > 1 && result.hist.back() != 0)
+        ::report_failure("Invalid file format");
+
+    result.hist.resize(img.max_val + 1);
+    return result;
+}
+
+#endif
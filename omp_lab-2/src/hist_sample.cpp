@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <omp.h>
+
+#include "hist_sample.h"
+#include "histogram.h"
+
+
+double sample_fraction(const Image_View &img, double error) {
+    double pixels = static_cast<double>(img.width) * img.height;
+    double needed = 1.96 * 1.96 / (4 * error * error);
+
+    return pixels > 0 ? std::min(needed / pixels, 1.0) : 1.0;
+}
+
+
+Sampled_Hist sample_histogram(Image_View img, double fraction, std::string_view engine_name, bool omp_enable) {
+    Sampled_Hist result;
+    // Every replicate takes a row at least, so the step is capped by the height: a tiny
+    // fraction of a short image does not leave the replicates empty
+    double max_step = std::max(img.height / SAMPLE_GROUPS, 1u);
+    std::size_t step = static_cast<std::size_t>(std::max(std::round(std::min(1 / fraction, max_step)), 1.0));
+    std::size_t period = step * SAMPLE_GROUPS;
+    std::size_t bins = img.max_val + 1;
+    int threads = omp_enable ? omp_get_max_threads() : 1;
+
+    // Every row is counted, nothing to estimate
+    if (step == 1) {
+        result.engine_name = engine_name == "auto" ? ::select_engine(img, threads) : engine_name;
+        const Engine &engine = engines.at(result.engine_name);
+
+        result.hist = (omp_enable ? engine.omp : engine.no_omp)(img);
+        result.bounds.assign(bins, 0);
+        result.fraction = 1;
+        return result;
+    }
+
+    std::mt19937 random(SAMPLE_SEED);
+    std::uniform_int_distribution<std::size_t> start(0, period - 1);
+    std::vector<double> sum(bins, 0), sum_squares(bins, 0);
+    std::size_t rows = 0;
+
+    for (unsigned int group = 0; group < SAMPLE_GROUPS; ++group) {
+        std::size_t first = start(random);
+        unsigned int height = first < img.height ? static_cast<unsigned int>((img.height - first + period - 1) / period) : 0;
+        Image_View replicate = {height ? img.data + first * img.stride : img.data, img.width, height,
+                                img.stride * period, img.max_val};
+
+        if (group == 0)
+            result.engine_name = engine_name == "auto" ? ::select_engine(replicate, threads) : engine_name;
+
+        const Engine &engine = engines.at(result.engine_name);
+        Image_Hist counts = (omp_enable ? engine.omp : engine.no_omp)(replicate);
+
+        // A row gets into the replicate with the probability 1 / period
+        for (std::size_t v = 0; v < bins; ++v) {
+            double estimate = static_cast<double>(counts[v]) * period;
+
+            sum[v] += estimate;
+            sum_squares[v] += estimate * estimate;
+        }
+        rows += height;
+    }
+
+    result.hist.resize(bins);
+    result.bounds.resize(bins);
+    result.fraction = static_cast<double>(rows) / img.height;
+
+    for (std::size_t v = 0; v < bins; ++v) {
+        double mean = sum[v] / SAMPLE_GROUPS;
+        double variance = std::max(sum_squares[v] - SAMPLE_GROUPS * mean * mean, 0.0) / (SAMPLE_GROUPS - 1);
+
+        double bound = SAMPLE_T_QUANTILE * std::sqrt(variance / SAMPLE_GROUPS);
+
+        // Rare values may miss every replicate, then the spread says nothing: a value never
+        // met among n sampled pixels may still take 3 / n of the image (the rule of three)
+        result.hist[v] = static_cast<std::uint32_t>(std::lround(mean));
+        double rule_of_three = rows ? 3 / result.fraction : 0;
+
+        result.bounds[v] = static_cast<std::uint32_t>(std::ceil(std::max(bound, rule_of_three)));
+    }
+
+    return result;
+}
@@ -0,0 +1,114 @@
+#include <cstdlib>
+#include <string_view>
+#include <immintrin.h>
+#include "hist_simd.h"
+
+
+// Four sub-histograms, the pixel i goes to the sub-histogram i % 4
+static void hist_count_scalar(const std::uint8_t *data, std::size_t n, std::uint32_t *table) {
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        ++table[data[i] * 4u];
+        ++table[data[i + 1] * 4u + 1];
+        ++table[data[i + 2] * 4u + 2];
+        ++table[data[i + 3] * 4u + 3];
+    }
+
+    for (; i < n; ++i)
+        ++table[data[i] * 4u];
+}
+
+
+// Eight sub-histograms. AVX2 has no scatter, so the indices of 32 pixels are
+// computed by vectors and the increments are scalar
+__attribute__((target("avx2")))
+static void hist_count_avx2(const std::uint8_t *data, std::size_t n, std::uint32_t *table) {
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    alignas(32) std::uint32_t index[32];
+    std::size_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m128i low = _mm256_castsi256_si128(bytes);
+        __m128i high = _mm256_extracti128_si256(bytes, 1);
+
+        __m256i index_0 = _mm256_cvtepu8_epi32(low);
+        __m256i index_1 = _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8));
+        __m256i index_2 = _mm256_cvtepu8_epi32(high);
+        __m256i index_3 = _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8));
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(index), _mm256_add_epi32(_mm256_slli_epi32(index_0, 3), lane));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(index + 8), _mm256_add_epi32(_mm256_slli_epi32(index_1, 3), lane));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(index + 16), _mm256_add_epi32(_mm256_slli_epi32(index_2, 3), lane));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(index + 24), _mm256_add_epi32(_mm256_slli_epi32(index_3, 3), lane));
+
+        for (int j = 0; j < 32; ++j)
+            ++table[index[j]];
+    }
+
+    for (; i < n; ++i)
+        ++table[data[i] * 8u];
+}
+
+
+// GCC 12 fills the unused destination of the AVX-512 intrinsics by a self
+// initialized _mm512_undefined_epi32(), which -Wmaybe-uninitialized reports
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// 32 sub-histograms: two vectors of 16 pixels are counted by gather / add / scatter,
+// every lane of both has its own sub-histogram, so the lanes never conflict
+__attribute__((target("avx512f")))
+static void hist_count_avx512(const std::uint8_t *data, std::size_t n, std::uint32_t *table) {
+    const __m512i lane_0 = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i lane_1 = _mm512_add_epi32(lane_0, _mm512_set1_epi32(16));
+    const __m512i one = _mm512_set1_epi32(1);
+    int *counts = reinterpret_cast<int*>(table);
+    std::size_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m512i pixels_0 = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+        __m512i pixels_1 = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16)));
+        __m512i index_0 = _mm512_add_epi32(_mm512_slli_epi32(pixels_0, 5), lane_0);
+        __m512i index_1 = _mm512_add_epi32(_mm512_slli_epi32(pixels_1, 5), lane_1);
+
+        __m512i counts_0 = _mm512_i32gather_epi32(index_0, counts, 4);
+        __m512i counts_1 = _mm512_i32gather_epi32(index_1, counts, 4);
+        _mm512_i32scatter_epi32(counts, index_0, _mm512_add_epi32(counts_0, one), 4);
+        _mm512_i32scatter_epi32(counts, index_1, _mm512_add_epi32(counts_1, one), 4);
+    }
+
+    for (; i < n; ++i)
+        ++table[data[i] * 32u];
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+
+const Hist_Kernel HIST_KERNEL_SCALAR = {"scalar", 4, hist_count_scalar};
+const Hist_Kernel HIST_KERNEL_AVX2 = {"avx2", 8, hist_count_avx2};
+const Hist_Kernel HIST_KERNEL_AVX512 = {"avx512", 32, hist_count_avx512};
+
+
+const Hist_Kernel &hist_kernel() {
+    static const Hist_Kernel &kernel = []() -> const Hist_Kernel & {
+        const char *forced = std::getenv("HIST_KERNEL");
+        std::string_view name = forced ? forced : "";
+
+        if (name == "scalar")
+            return HIST_KERNEL_SCALAR;
+        if ((name.empty() || name == "avx512") && __builtin_cpu_supports("avx512f"))
+            return HIST_KERNEL_AVX512;
+        if ((name.empty() || name == "avx2") && __builtin_cpu_supports("avx2"))
+            return HIST_KERNEL_AVX2;
+
+        return HIST_KERNEL_SCALAR;
+    }();
+
+    return kernel;
+}
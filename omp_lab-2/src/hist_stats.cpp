@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+
+#include "hist_stats.h"
+#include "lut_simd.h"
+#include "omp_estimator.h"
+
+
+Hist_Stats histogram_stats(const Image_Hist &hist) {
+    Hist_Stats stats;
+    std::uint64_t total = 0;
+    double sum = 0;
+
+    stats.cdf.resize(hist.size());
+    stats.min = stats.max = 0;
+
+    for (std::size_t v = 0; v < hist.size(); ++v) {
+        if (hist[v] && !total)
+            stats.min = static_cast<unsigned int>(v);
+        if (hist[v])
+            stats.max = static_cast<unsigned int>(v);
+
+        total += hist[v];
+        sum += static_cast<double>(v) * hist[v];
+        stats.cdf[v] = total;
+    }
+
+    stats.mean = total ? sum / total : 0;
+
+    // Otsu: the threshold maximizing the variance between the background and the foreground
+    double best_variance = -1;
+    double background_sum = 0;
+
+    stats.otsu_threshold = stats.min;
+    for (std::size_t t = stats.min; t < stats.max; ++t) {
+        double background = static_cast<double>(stats.cdf[t]);
+        double foreground = static_cast<double>(total) - background;
+
+        background_sum += static_cast<double>(t) * hist[t];
+
+        double difference = background_sum / background - (sum - background_sum) / foreground;
+        double variance = background * foreground * difference * difference;
+
+        if (variance > best_variance) {
+            best_variance = variance;
+            stats.otsu_threshold = static_cast<unsigned int>(t);
+        }
+    }
+
+    // Equalization maps the least value to 0 and the cdf of the rest linearly onto
+    // 1..max value, an image of a single value is left as it is
+    std::uint64_t cdf_min = total ? stats.cdf[stats.min] : 0;
+    double scale = total > cdf_min ? static_cast<double>(hist.size() - 1) / (total - cdf_min) : 0;
+
+    stats.equalization.resize(hist.size());
+    for (std::size_t v = 0; v < hist.size(); ++v) {
+        if (total == cdf_min)
+            stats.equalization[v] = static_cast<std::uint16_t>(v);
+        else
+            stats.equalization[v] = static_cast<std::uint16_t>(
+                std::lround(static_cast<double>(stats.cdf[v] > cdf_min ? stats.cdf[v] - cdf_min : 0) * scale));
+    }
+
+    return stats;
+}
+
+
+// Remaps a row of n samples into out, the table of bytes is used by 8-bit images only
+static void remap_row(const std::uint8_t *line, std::size_t n, unsigned int depth, const Image_Lut &lut,
+                      const std::uint8_t *lut_bytes, std::uint8_t *out) {
+    if (depth == 1) {
+        lut_kernel().apply(line, n, lut_bytes, out);
+        return;
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint16_t value = lut[sample_value<2>(line, i)];
+
+        out[2 * i] = static_cast<std::uint8_t>(value >> 8);
+        out[2 * i + 1] = static_cast<std::uint8_t>(value);
+    }
+}
+
+
+// Byte table of an 8-bit lut, padded up to the 256 entries read by the kernels
+static std::vector<std::uint8_t> lut_bytes(const Image_Lut &lut) {
+    std::vector<std::uint8_t> bytes(256, 0);
+
+    for (std::size_t v = 0; v < std::min<std::size_t>(lut.size(), 256); ++v)
+        bytes[v] = static_cast<std::uint8_t>(lut[v]);
+
+    return bytes;
+}
+
+
+std::vector<std::uint8_t> apply_lut(Image_View img, Image_Lut lut) {
+    unsigned int depth = sample_size(img.max_val);
+    std::size_t row_size = static_cast<std::size_t>(img.width) * depth;
+    std::vector<std::uint8_t> result(row_size * img.height);
+    std::vector<std::uint8_t> bytes = ::lut_bytes(lut);
+
+    omp_estimator::timer_begin();
+    #pragma omp parallel for schedule(static)
+    for (unsigned row = 0; row < img.height; ++row)
+        ::remap_row(img.data + row * img.stride, img.width, depth, lut, bytes.data(), result.data() + row * row_size);
+    omp_estimator::timer_end();
+
+    return result;
+}
+
+
+std::vector<std::uint8_t> apply_lut_no_omp(Image_View img, Image_Lut lut) {
+    unsigned int depth = sample_size(img.max_val);
+    std::size_t row_size = static_cast<std::size_t>(img.width) * depth;
+    std::vector<std::uint8_t> result(row_size * img.height);
+    std::vector<std::uint8_t> bytes = ::lut_bytes(lut);
+
+    omp_estimator::timer_begin();
+    for (unsigned row = 0; row < img.height; ++row)
+        ::remap_row(img.data + row * img.stride, img.width, depth, lut, bytes.data(), result.data() + row * row_size);
+    omp_estimator::timer_end();
+
+    return result;
+}
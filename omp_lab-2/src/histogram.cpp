@@ -0,0 +1,475 @@
+#include <algorithm>
+#include <vector>
+#include <omp.h>
+
+#include "histogram.h"
+#include "hist_arena.h"
+#include "hist_simd.h"
+#include "omp_estimator.h"
+
+
+// Engine picked by select_engine (see data/perf_test_strategy.txt): private tables
+// while zeroing and merging them (bins * threads counters) is cheap against the
+// counting, then the radix engine, unless its passes and barriers are too long
+// for the share of a thread, where the atomics are left
+constexpr std::size_t PRIVATE_MAX_COUNTERS_PER_PIXEL = 4;
+constexpr std::size_t RADIX_MIN_PIXELS_PER_THREAD = 4096;
+
+
+// 16-bit samples of a loaded image are checked against the max value by the
+// counting pass itself rather than by a separate one: samples above it are
+// counted into the bins past the last one, which must be empty in the end
+static std::size_t count_bins(unsigned int max_val) {
+    return max_val + (sample_size(max_val) > 1 ? 2 : 1);
+}
+
+static void check_samples(Image_Hist &hist, unsigned int max_val) {
+    if (std::any_of(hist.begin() + max_val + 1, hist.end(), [](std::uint32_t count) { return count != 0; }))
+        ::report_failure("Invalid file format");
+
+    hist.resize(max_val + 1);
+}
+
+// Index of the sample i of a row in a table of count_bins(max_val) bins
+template <unsigned int depth>
+static unsigned int sample_bin(const std::uint8_t *line, std::size_t i, unsigned int max_val) {
+    if constexpr (depth == 1)
+        return sample_value<1>(line, i);
+    else
+        return std::min(sample_value<2>(line, i), max_val + 1);
+}
+
+
+// Adds n samples of a row to the table
+template <unsigned int depth>
+static void count_samples(std::uint32_t *hist, const std::uint8_t *line, std::size_t n, unsigned int max_val) {
+    for (std::size_t i = 0; i < n; ++i)
+        ++hist[sample_bin<depth>(line, i, max_val)];
+}
+
+static void count_samples(std::uint32_t *hist, const std::uint8_t *line, std::size_t n, unsigned int max_val) {
+    if (sample_size(max_val) == 1)
+        ::count_samples<1>(hist, line, n, max_val);
+    else
+        ::count_samples<2>(hist, line, n, max_val);
+}
+
+
+// Sums the tables of the team into the histogram, the sub-histograms of a table
+// are interleaved by lanes. Called by the whole team (or outside of a parallel
+// region): the bins are shared by cache lines, every thread sums its range over
+// all the tables, so there is neither a serial pass nor a write conflict
+static void merge_tables(const Hist_Arena &arena, int tables_num, unsigned lanes, Image_Hist &hist_result) {
+    constexpr std::size_t line = Hist_Arena::CACHE_LINE / sizeof(std::uint32_t);
+    std::size_t bins = hist_result.size();
+
+    #pragma omp for schedule(static)
+    for (std::size_t first = 0; first < bins; first += line) {
+        std::size_t count = std::min(line, bins - first);
+        std::uint32_t sum[line] = {};
+
+        for (int t = 0; t < tables_num; ++t) {
+            const std::uint32_t *table = arena.table(t) + first * lanes;
+
+            #pragma omp simd
+            for (std::size_t i = 0; i < count; ++i) {
+                for (unsigned lane = 0; lane < lanes; ++lane)
+                    sum[i] += table[i * lanes + lane];
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+            hist_result[first + i] = sum[i];
+    }
+}
+
+
+Image_Hist compute_histogram(Image_View img) {
+    Image_Hist hist_result(::count_bins(img.max_val), 0);
+
+    omp_estimator::timer_begin();   // Start of the time measurement
+
+    const std::uint8_t* data = img.data;
+    std::size_t size = static_cast<std::size_t>(img.width) * img.height;
+    // Rows of a sub-region are not adjacent, then the rows are shared instead of pixels
+    // (as well as the rows of 16-bit samples, which are not counted by the flat loop)
+    bool contiguous = img.stride == img.width;
+    std::size_t remainder = contiguous ? size % 4 : 0;
+    Hist_Arena &arena = ::caller_arena();
+    int team_size = 1;
+
+    arena.reserve(omp_get_max_threads(), hist_result.size());
+
+    #pragma omp parallel
+    {
+        std::uint32_t* hist = arena.claim(omp_get_thread_num());
+
+        #pragma omp master
+        team_size = omp_get_num_threads();
+
+        if (contiguous) {
+            #pragma omp for schedule(runtime)
+            for (std::size_t i = 0; i < size - remainder; i += 4) {
+                ++hist[data[i]];
+                ++hist[data[i + 1]];
+                ++hist[data[i + 2]];
+                ++hist[data[i + 3]];
+            }
+        } else {
+            #pragma omp for schedule(runtime)
+            for (unsigned row = 0; row < img.height; row++)
+                ::count_samples(hist, data + row * img.stride, img.width, img.max_val);
+        }
+
+        // All the tables are complete after the barrier of the loop
+        #pragma omp master
+        omp_estimator::timer_stage();
+
+        ::merge_tables(arena, team_size, 1, hist_result);
+    }
+
+    switch (remainder) {
+        case 3: ++hist_result[data[size - 3]];
+        case 2: ++hist_result[data[size - 2]];
+        case 1: ++hist_result[data[size - 1]];
+        case 0: break;
+    }
+
+    ::check_samples(hist_result, img.max_val);
+    omp_estimator::timer_end();     // End of the time measurement
+
+    return hist_result;
+}
+
+
+Image_Hist compute_histogram_no_omp(Image_View img) {
+    Image_Hist hist_result(::count_bins(img.max_val), 0);
+    
+    omp_estimator::timer_begin();
+    for (unsigned row = 0; row < img.height; ++row)
+        ::count_samples(hist_result.data(), img.data + row * img.stride, img.width, img.max_val);
+    ::check_samples(hist_result, img.max_val);
+    omp_estimator::timer_end();
+
+    return hist_result;
+}
+
+
+// Pixels of a contiguous view are shared between threads by blocks of this size
+constexpr std::size_t HIST_BLOCK_SIZE = 1 << 14;
+
+
+Image_Hist compute_histogram_simd(Image_View img) {
+    Image_Hist hist_result(img.max_val + 1, 0);
+    const Hist_Kernel &kernel = hist_kernel();
+
+    omp_estimator::timer_begin();
+
+    std::size_t size = static_cast<std::size_t>(img.width) * img.height;
+    bool contiguous = img.stride == img.width;
+    Hist_Arena &arena = ::caller_arena();
+    int team_size = 1;
+
+    arena.reserve(omp_get_max_threads(), hist_result.size() * kernel.lanes);
+
+    #pragma omp parallel
+    {
+        std::uint32_t *table = arena.claim(omp_get_thread_num());
+
+        #pragma omp master
+        team_size = omp_get_num_threads();
+
+        if (contiguous) {
+            #pragma omp for schedule(runtime)
+            for (std::size_t block = 0; block < size; block += HIST_BLOCK_SIZE)
+                kernel.count(img.data + block, std::min(HIST_BLOCK_SIZE, size - block), table);
+        } else {
+            #pragma omp for schedule(runtime)
+            for (unsigned row = 0; row < img.height; row++)
+                kernel.count(img.data + row * img.stride, img.width, table);
+        }
+
+        #pragma omp master
+        omp_estimator::timer_stage();
+
+        ::merge_tables(arena, team_size, kernel.lanes, hist_result);
+    }
+
+    omp_estimator::timer_end();
+
+    return hist_result;
+}
+
+
+Image_Hist compute_histogram_simd_no_omp(Image_View img) {
+    Image_Hist hist_result(img.max_val + 1, 0);
+    const Hist_Kernel &kernel = hist_kernel();
+
+    omp_estimator::timer_begin();
+    Hist_Arena &arena = ::caller_arena();
+
+    arena.reserve(1, hist_result.size() * kernel.lanes);
+    std::uint32_t *table = arena.claim(0);
+
+    for (unsigned row = 0; row < img.height; ++row)
+        kernel.count(img.data + row * img.stride, img.width, table);
+
+    omp_estimator::timer_stage();
+    ::merge_tables(arena, 1, kernel.lanes, hist_result);
+    omp_estimator::timer_end();
+
+    return hist_result;
+}
+
+
+template <unsigned int depth>
+static void count_samples_atomic(std::uint32_t *hist, const std::uint8_t *line, std::size_t n, unsigned int max_val) {
+    for (std::size_t i = 0; i < n; ++i) {
+        #pragma omp atomic
+        ++hist[sample_bin<depth>(line, i, max_val)];
+    }
+}
+
+
+// No table is private, so the memory does not grow with the team and there is
+// nothing to merge, while every increment is an atomic one
+Image_Hist compute_histogram_atomic(Image_View img) {
+    Image_Hist hist_result(::count_bins(img.max_val), 0);
+
+    omp_estimator::timer_begin();
+
+    std::uint32_t *hist = hist_result.data();
+    unsigned depth = sample_size(img.max_val);
+
+    #pragma omp parallel for schedule(runtime)
+    for (unsigned row = 0; row < img.height; row++) {
+        if (depth == 1)
+            ::count_samples_atomic<1>(hist, img.data + row * img.stride, img.width, img.max_val);
+        else
+            ::count_samples_atomic<2>(hist, img.data + row * img.stride, img.width, img.max_val);
+    }
+
+    ::check_samples(hist_result, img.max_val);
+    omp_estimator::timer_end();
+
+    return hist_result;
+}
+
+
+constexpr std::size_t RADIX_BUCKETS = 256;
+
+
+// Counting by the high byte first. The samples are scattered into 256 buckets by
+// their high byte, keeping only the low one, then every bucket is counted by a
+// single thread straight into its 256 bins of the result. Per-thread tables are
+// 256 counters whatever the depth, the buffer takes a byte per pixel. Offsets
+// into the buffer are std::size_t, it may hold more than 4G pixels. Samples
+// above the max value fall into the bins of the last bucket past it or into the
+// buckets past the last one, the latter are marked in the bin after all of them
+Image_Hist compute_histogram_radix(Image_View img) {
+    std::size_t buckets = (img.max_val + RADIX_BUCKETS) / RADIX_BUCKETS;
+    Image_Hist hist_result(buckets * RADIX_BUCKETS + 1, 0);
+
+    omp_estimator::timer_begin();
+
+    std::size_t size = static_cast<std::size_t>(img.width) * img.height;
+    unsigned depth = sample_size(img.max_val);
+    static thread_local std::vector<std::uint8_t> caller_buffer;
+    static thread_local std::vector<std::size_t> caller_offsets;
+    Hist_Arena &arena = ::caller_arena();
+    std::vector<std::uint8_t> &low_bytes = caller_buffer;
+    std::vector<std::size_t> &share_offset = caller_offsets;
+    std::size_t bucket_begin[RADIX_BUCKETS + 1];
+    int team_size = 1;
+
+    arena.reserve(omp_get_max_threads(), RADIX_BUCKETS);
+    if (low_bytes.size() < size)
+        low_bytes.resize(size);
+    share_offset.resize(static_cast<std::size_t>(omp_get_max_threads()) * RADIX_BUCKETS);
+
+    #pragma omp parallel
+    {
+        std::uint32_t *bucket_size = arena.claim(omp_get_thread_num());
+        std::size_t position[RADIX_BUCKETS];
+
+        #pragma omp master
+        team_size = omp_get_num_threads();
+
+        // Both passes have the same static schedule, i.e. every thread gets the
+        // same rows, and its share of a bucket is where the previous threads end
+        #pragma omp for schedule(static)
+        for (unsigned row = 0; row < img.height; row++) {
+            const std::uint8_t *line = img.data + row * img.stride;
+
+            if (depth == 1) {
+                bucket_size[0] += img.width;
+            } else {
+                for (unsigned col = 0; col < img.width; col++)
+                    ++bucket_size[line[2 * col]];
+            }
+        }
+
+        // Sizes of the buckets and the offset of the share of every thread
+        // within its bucket
+        #pragma omp for schedule(static)
+        for (std::size_t b = 0; b < RADIX_BUCKETS; ++b) {
+            std::size_t offset = 0;
+
+            for (int t = 0; t < team_size; ++t) {
+                share_offset[t * RADIX_BUCKETS + b] = offset;
+                offset += arena.table(t)[b];
+            }
+            bucket_begin[b + 1] = offset;
+        }
+
+        #pragma omp single
+        {
+            bucket_begin[0] = 0;
+            for (std::size_t b = 0; b < RADIX_BUCKETS; ++b)
+                bucket_begin[b + 1] += bucket_begin[b];
+        }
+
+        const std::size_t *offset = share_offset.data() + omp_get_thread_num() * RADIX_BUCKETS;
+
+        for (std::size_t b = 0; b < RADIX_BUCKETS; ++b)
+            position[b] = bucket_begin[b] + offset[b];
+
+        #pragma omp for schedule(static)
+        for (unsigned row = 0; row < img.height; row++) {
+            const std::uint8_t *line = img.data + row * img.stride;
+
+            if (depth == 1) {
+                std::copy(line, line + img.width, low_bytes.data() + position[0]);
+                position[0] += img.width;
+            } else {
+                for (unsigned col = 0; col < img.width; col++)
+                    low_bytes[position[line[2 * col]]++] = line[2 * col + 1];
+            }
+        }
+
+        #pragma omp for schedule(dynamic)
+        for (std::size_t b = 0; b < buckets; ++b) {
+            std::uint32_t *hist = hist_result.data() + b * RADIX_BUCKETS;
+
+            for (std::size_t i = bucket_begin[b]; i < bucket_begin[b + 1]; ++i)
+                ++hist[low_bytes[i]];
+        }
+    }
+
+    hist_result.back() = bucket_begin[RADIX_BUCKETS] != bucket_begin[buckets];
+    ::check_samples(hist_result, img.max_val);
+    omp_estimator::timer_end();
+
+    return hist_result;
+}
+
+
+// Luma of BT.601 in fixed point, the weights sum up to 256, i.e. it never exceeds the max value
+constexpr unsigned int LUMA_RED = 77, LUMA_GREEN = 150, LUMA_BLUE = 29;
+
+
+// Adds n interleaved pixels to the tables of the channels, which are bins apart.
+// Channels go to tables of their own, so equal samples of a pixel (gray areas) do
+// not wait for each other's increment
+template <unsigned int depth, bool luma>
+static void count_pixels(std::uint32_t *hist, std::size_t bins, const std::uint8_t *line, std::size_t n) {
+    std::uint32_t *red = hist, *green = hist + bins, *blue = hist + 2 * bins, *gray = hist + 3 * bins;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        unsigned int r = sample_value<depth>(line, 3 * i);
+        unsigned int g = sample_value<depth>(line, 3 * i + 1);
+        unsigned int b = sample_value<depth>(line, 3 * i + 2);
+
+        ++red[r];
+        ++green[g];
+        ++blue[b];
+        if constexpr (luma)
+            ++gray[(LUMA_RED * r + LUMA_GREEN * g + LUMA_BLUE * b + 128) >> 8];
+    }
+}
+
+static void count_pixels(std::uint32_t *hist, std::size_t bins, const std::uint8_t *line, std::size_t n,
+                         unsigned depth, bool luma) {
+    if (depth == 1)
+        luma ? ::count_pixels<1, true>(hist, bins, line, n) : ::count_pixels<1, false>(hist, bins, line, n);
+    else
+        luma ? ::count_pixels<2, true>(hist, bins, line, n) : ::count_pixels<2, false>(hist, bins, line, n);
+}
+
+
+Image_Hist compute_color_histogram(Image_View img, bool luma) {
+    std::size_t bins = img.max_val + 1;
+    Image_Hist hist_result(bins * (luma ? 4 : 3), 0);
+
+    omp_estimator::timer_begin();
+
+    std::size_t size = static_cast<std::size_t>(img.width) * img.height;
+    unsigned depth = sample_size(img.max_val);
+    std::size_t pixel_size = depth * 3;
+    // Pixels of a whole image are shared by blocks, rows of a sub-region one by one
+    bool contiguous = img.stride == img.width * pixel_size;
+    Hist_Arena &arena = ::caller_arena();
+    int team_size = 1;
+
+    arena.reserve(omp_get_max_threads(), hist_result.size());
+
+    #pragma omp parallel
+    {
+        std::uint32_t *hist = arena.claim(omp_get_thread_num());
+
+        #pragma omp master
+        team_size = omp_get_num_threads();
+
+        if (contiguous) {
+            #pragma omp for schedule(runtime)
+            for (std::size_t block = 0; block < size; block += HIST_BLOCK_SIZE)
+                ::count_pixels(hist, bins, img.data + block * pixel_size, std::min(HIST_BLOCK_SIZE, size - block),
+                               depth, luma);
+        } else {
+            #pragma omp for schedule(runtime)
+            for (unsigned row = 0; row < img.height; row++)
+                ::count_pixels(hist, bins, img.data + row * img.stride, img.width, depth, luma);
+        }
+
+        #pragma omp master
+        omp_estimator::timer_stage();
+
+        ::merge_tables(arena, team_size, 1, hist_result);
+    }
+
+    omp_estimator::timer_end();
+
+    return hist_result;
+}
+
+
+Image_Hist compute_color_histogram_no_omp(Image_View img, bool luma) {
+    std::size_t bins = img.max_val + 1;
+    Image_Hist hist_result(bins * (luma ? 4 : 3), 0);
+
+    omp_estimator::timer_begin();
+    for (unsigned row = 0; row < img.height; ++row)
+        ::count_pixels(hist_result.data(), bins, img.data + row * img.stride, img.width, sample_size(img.max_val), luma);
+    omp_estimator::timer_end();
+
+    return hist_result;
+}
+
+
+const std::map<std::string_view, Engine> engines = {
+    {"privatized", {compute_histogram, compute_histogram_no_omp, true}},
+    {"simd",       {compute_histogram_simd, compute_histogram_simd_no_omp, false}},
+    {"atomic",     {compute_histogram_atomic, compute_histogram_no_omp, true}},
+    {"radix",      {compute_histogram_radix, compute_histogram_no_omp, true}}
+};
+
+
+std::string_view select_engine(const Image_View &img, int threads) {
+    std::size_t pixels = static_cast<std::size_t>(img.width) * img.height;
+    std::size_t counters = static_cast<std::size_t>(img.max_val + 1) * threads;
+
+    if (threads == 1 || counters <= PRIVATE_MAX_COUNTERS_PER_PIXEL * pixels)
+        return "privatized";
+
+    return pixels >= RADIX_MIN_PIXELS_PER_THREAD * threads ? "radix" : "atomic";
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "P5_Image.h"
+
+
+// Files at least this large are counted one by one by the whole team, smaller
+// ones are spread over the team and counted by a single thread each
+constexpr std::uintmax_t BATCH_LARGE_FILE_SIZE = 1 << 22;
+
+
+typedef struct {
+    std::vector<std::string> names;
+    std::vector<Image_Hist> hists;  // in the order of the names
+    std::size_t large;              // images counted by the whole team
+    double time;                    // from the first image loaded up to the last histogram, ms
+} Batch_Histograms;
+
+// Names of the P5 images of a directory (the "*.pgm" files, sorted) or of a file
+// list (a path per line, empty lines are skipped)
+std::vector<std::string> list_batch(std::string path);
+
+// Histograms of all the images, "auto" chooses the engine for every image
+Batch_Histograms batch_histograms(const std::vector<std::string> &names, std::string_view engine_name,
+                                  bool omp_enable);
+
+// Consolidated output: the number of images, the index (per image: the offset of
+// its histogram from the start of the file as uint64, the number of bins and the
+// length of its name as uint32), the names one after another, then the histograms
+void save_batch(std::string filename, const Batch_Histograms &batch);
@@ -1,15 +1,73 @@
 #pragma once
+#include <memory>
 #include <vector>
+#include <string>
+#include <string_view>
 #include <cstdint>
 #include "utilities.h"
 
 
+// Pixels are not copied out of the file: data points into its memory mapping
+// (or into a buffer, when the file cannot be mapped), kept alive by storage.
+// Color P6 images are read as well, their pixels are interleaved R, G, B samples
 typedef struct {
     unsigned int width, height, max_val;
-    std::vector<std::uint8_t> data;
+    const std::uint8_t *data;
+    std::shared_ptr<const std::uint8_t> storage;
+    unsigned int channels;          // 1 for P5, 3 for P6
 } P5_Image;
 
+// Non-owning view of pixels: row r starts at data + r * stride (in bytes). Views
+// are cheap to copy, the owner of the pixels (P5_Image, a buffer) must outlive them
+typedef struct {
+    const std::uint8_t *data;
+    unsigned int width, height;
+    std::size_t stride;
+    unsigned int max_val;
+    unsigned int channels = 1;      // samples per pixel, interleaved
+} Image_View;
+
 typedef std::vector<std::uint32_t> Image_Hist;
 
+
+// Samples take a byte up to max value 255 and two bytes (most significant first) above
+inline unsigned int sample_size(unsigned int max_val) {
+    return max_val < 256 ? 1 : 2;
+}
+
+// Value of the sample i of a row, depth is the sample size in bytes
+template <unsigned int depth>
+inline unsigned int sample_value(const std::uint8_t *line, std::size_t i) {
+    if constexpr (depth == 1)
+        return line[i];
+    else
+        return static_cast<unsigned int>(line[2 * i]) << 8 | line[2 * i + 1];
+}
+
+// Whether none of the samples exceeds the max value, i.e. the tables of max value + 1
+// bins are never indexed out of their bounds. 8-bit pixels are checked once, where
+// they are read. 16-bit pixels of a loaded image are checked by the counting pass
+// of the histogram engines, other passes over them have to call this first
+bool samples_within(const std::uint8_t *data, std::size_t samples, unsigned int max_val);
+
 constexpr static auto& save_histogram = write_vector_to_file<std::uint32_t>;
-P5_Image read_P5_image_from_file(std::string filename);
\ No newline at end of file
+P5_Image read_P5_image_from_file(std::string filename);
+// Same, but a failure sets the error and returns an empty image instead of exiting.
+// 16-bit samples are not checked against the max value (see samples_within)
+P5_Image try_read_P5_image_from_file(std::string filename, std::string_view &error);
+// Writes the contiguous pixels (in the sample size of the max value) with a P5 header
+void write_P5_image_to_file(std::string filename, const std::vector<std::uint8_t> &pixels,
+                            unsigned int width, unsigned int height, unsigned int max_val);
+// Parses the P5 or P6 header at the beginning of the data into the image (the
+// pixels are left unset), returns the number of bytes taken by the header
+std::size_t parse_P5_header(const std::uint8_t *data, std::size_t size, P5_Image &img);
+// Same, but an invalid header sets the error and returns 0 instead of exiting, for
+// the threads, which must leave the failure to the main one
+std::size_t try_parse_P5_header(const std::uint8_t *data, std::size_t size, P5_Image &img, std::string_view &error);
+
+Image_View image_view(const P5_Image &img);
+Image_View image_view(const std::vector<std::uint8_t> &pixels, unsigned int width, unsigned int height,
+                      unsigned int max_val);
+// Rectangle of the view, it must lie within the view
+Image_View image_view(const Image_View &view, unsigned int x, unsigned int y,
+                      unsigned int width, unsigned int height);
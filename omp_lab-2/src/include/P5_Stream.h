@@ -0,0 +1,58 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include <vector>
+#include <string_view>
+#include "P5_Image.h"
+#include "hist_delta.h"
+
+
+// Chunks of the pixels are this large by default, rounded down to whole rows
+constexpr std::size_t STREAM_CHUNK_SIZE = 1 << 24;
+// Buffers between the reader and the team: one is filled while the others are counted
+constexpr std::size_t STREAM_BUFFERS = 3;
+
+
+typedef struct {
+    Image_Hist hist;
+    std::string_view engine_name;   // engine, which counted the chunks
+    std::size_t chunks;
+    std::size_t buffer_size;        // memory taken by all the buffers, bytes
+    double time;                    // from the header up to the last chunk, ms
+    double wait_time;               // the team waited for the reader, ms
+} Stream_Histogram;
+
+// Histogram of a P5 image, which is never held in memory as a whole. A reader
+// thread reads the pixels by chunks of whole rows into a ring of STREAM_BUFFERS
+// buffers, while the team counts the filled ones by the engine ("auto" is chosen
+// by the size of a chunk), so the reading overlaps the counting
+Stream_Histogram stream_histogram(std::string filename, std::size_t chunk_size,
+                                  std::string_view engine_name, bool omp_enable);
+
+
+typedef struct {
+    std::string_view engine_name;   // engine, which counted the first frame
+    std::size_t frames;
+    std::size_t missed;             // frames with the latency above 1 / fps
+    std::size_t updated_pixels;     // pixels of the frames updated by delta
+    std::size_t changed_pixels;     // pixels of them, which differed from the previous frame
+    double time;                    // from the start up to the last histogram, ms
+    std::vector<double> latencies;  // from the arrival of a frame up to its histogram, ms
+} Frame_Stream;
+
+// Histograms of the P5 frames concatenated in a file (a camera dump, a pipe). A
+// reader thread decodes the next frames into the ring of STREAM_BUFFERS buffers,
+// while the team counts the current one. A frame arrives, when the reader starts
+// to decode it, or, with a target rate fps > 0, 1 / fps s after the previous one
+// (the dump is replayed at that rate). Every histogram is written to out as its
+// number of bins followed by the bins, all of them uint32. With delta a frame of
+// the same shape as the previous one updates its histogram by the changed pixels
+// (see update_histogram), the previous buffer is kept for that. Frame n is then
+// compared within dirty[n - 1] (see read_dirty_list), the frames past the end of
+// dirty are compared as a whole
+Frame_Stream stream_frames(std::string filename, std::ostream &out, double fps,
+                           std::string_view engine_name, bool omp_enable, bool delta,
+                           const std::vector<std::vector<Image_Rect>> &dirty = {});
+
+// Latency, which is not exceeded by p percent of the frames
+double latency_percentile(const Frame_Stream &frames, double p);
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+
+// Position of the first byte, which differs between a and b, or n if none does
+typedef std::size_t (*diff_kernel_t)(const std::uint8_t *a, const std::uint8_t *b, std::size_t n);
+
+typedef struct {
+    const char *name;
+    diff_kernel_t mismatch;
+} Diff_Kernel;
+
+extern const Diff_Kernel DIFF_KERNEL_SCALAR;
+extern const Diff_Kernel DIFF_KERNEL_AVX2;
+extern const Diff_Kernel DIFF_KERNEL_AVX512;
+
+// Kernel chosen by the CPU features at the first call, $DIFF_KERNEL may force
+// one of "scalar", "avx2" or "avx512" (if the CPU supports it)
+const Diff_Kernel &diff_kernel();
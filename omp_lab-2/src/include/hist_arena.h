@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+
+// Per-thread histogram tables in a single heap block. Every table starts at its
+// own cache line, so neighbouring threads never write into the same line. The
+// block is kept between the calls and only grows, its pages are touched first
+// by the threads, which claim the tables (i.e. they land on their NUMA nodes)
+class Hist_Arena {
+public:
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    // Makes room for tables_num tables of table_size counters. The memory is
+    // kept if it is large enough, the contents are undefined until claimed
+    void reserve(std::size_t tables_num, std::size_t table_size);
+
+    // Zeroes the table and returns it, called by the thread, which owns it
+    std::uint32_t *claim(std::size_t index);
+
+    std::uint32_t *table(std::size_t index) { return memory.get() + index * stride; }
+    const std::uint32_t *table(std::size_t index) const { return memory.get() + index * stride; }
+    std::size_t table_size() const { return size; }
+
+private:
+    std::unique_ptr<std::uint32_t, decltype(&std::free)> memory{nullptr, std::free};
+    std::size_t capacity = 0;   // counters allocated
+    std::size_t stride = 0;     // counters between the tables, a multiple of a cache line
+    std::size_t size = 0;       // counters in a table
+};
+
+
+// Arena of the calling thread, kept between the calls of all the engines. The
+// team of an engine refers to it by a reference, thread_local names differ in
+// every thread
+Hist_Arena &caller_arena();
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "P5_Image.h"
+
+
+typedef struct {
+    unsigned int x, y, width, height;
+} Image_Rect;
+
+// Turns the histogram of the previous frame into the one of the current frame
+// (both of the same size and max value) within the dirty rectangles, the rest
+// of the frames must be equal. The rectangles are clipped to the frames, empty
+// ones are skipped and a pixel covered by several of them is compared once. The
+// rows are shared by the team and compared by a SIMD kernel (see diff_simd.h),
+// only the pixels, which differ, are subtracted and added, so the cost is a
+// compare of the dirty area plus an update per changed pixel. Returns the
+// changed pixels
+std::size_t update_histogram(Image_Hist &hist, Image_View previous, Image_View current,
+                             const std::vector<Image_Rect> &dirty, bool omp_enable);
+
+// The whole frames are dirty
+std::size_t update_histogram(Image_Hist &hist, Image_View previous, Image_View current, bool omp_enable);
+
+// Dirty rectangles of a sequence of frames: line n of the file lists the ones of
+// frame n against frame n - 1 (the first line is of the second frame) as x,y,w,h
+// separated by spaces, an empty line means the frames are equal
+std::vector<std::vector<Image_Rect>> read_dirty_list(std::string filename);
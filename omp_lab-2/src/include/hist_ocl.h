@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include "P5_Image.h"
+
+
+// Kernels are read by the path relative to the root folder, as the tests are run from it
+constexpr const char *OCL_KERNEL_FILE = "src/kernels/histogram.cl";
+
+typedef struct {
+    Image_Hist hist;
+    std::string device_name;
+    double kernel_time;     // both kernels by the profiling events, ms
+    double total_time;      // kernels and transfers of the buffers to the device, ms
+} Ocl_Histogram;
+
+
+// Histogram counted by the OpenCL device number $OCL_DEVICE (0 by default, devices
+// are sorted by ezocl: discrete GPUs, integrated ones, then CPUs). Every work-group
+// counts into tables in its local memory by the local atomics, then the partial
+// histograms of the groups are summed by the second kernel. The pixels of a
+// region are packed into a contiguous buffer before the transfer
+Ocl_Histogram compute_histogram_ocl(Image_View img);
@@ -0,0 +1,31 @@
+#pragma once
+#include <string_view>
+#include "P5_Image.h"
+
+
+// The sample is made of this many replicates, every one with its own random start
+constexpr unsigned int SAMPLE_GROUPS = 16;
+// Quantile of Student's t with SAMPLE_GROUPS - 1 degrees of freedom for 95% confidence
+constexpr double SAMPLE_T_QUANTILE = 2.131;
+// Random starts are reproducible from run to run
+constexpr unsigned int SAMPLE_SEED = 23;
+
+typedef struct {
+    Image_Hist hist;            // estimated counts of the whole image
+    Image_Hist bounds;          // half-widths of the 95% confidence intervals, rounded up
+    std::string_view engine_name;
+    double fraction;            // of the rows counted
+} Sampled_Hist;
+
+// Fraction of the rows, which keeps the bound of every bin within error * pixels
+// (by the normal approximation of the worst bin, p = 0.5), up to 1
+double sample_fraction(const Image_View &img, double error);
+
+// Histogram estimated from the rows of every step-th one, step = 1 / fraction up to
+// height / SAMPLE_GROUPS (an image of fewer rows is counted exactly).
+// The rows are counted as SAMPLE_GROUPS replicates of every (step * SAMPLE_GROUPS)-th
+// row from a random start, every replicate is a strided view counted by the
+// engine ("auto" is chosen by the size of a replicate). Every replicate gives an
+// unbiased estimate, the histogram is their mean and the bounds come from their
+// spread, so the correlation of the pixels of a row does not break the bounds
+Sampled_Hist sample_histogram(Image_View img, double fraction, std::string_view engine_name, bool omp_enable);
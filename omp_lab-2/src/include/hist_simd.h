@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+
+// Counts n pixels into a table of interleaved sub-histograms: the count of value v
+// in the sub-histogram l is table[v * lanes + l]. Neighbouring pixels go to
+// different sub-histograms, so a run of equal pixels does not chain the increments
+typedef void (*hist_kernel_t)(const std::uint8_t *data, std::size_t n, std::uint32_t *table);
+
+typedef struct {
+    const char *name;
+    unsigned int lanes;     // number of sub-histograms, a power of 2
+    hist_kernel_t count;
+} Hist_Kernel;
+
+extern const Hist_Kernel HIST_KERNEL_SCALAR;
+extern const Hist_Kernel HIST_KERNEL_AVX2;
+extern const Hist_Kernel HIST_KERNEL_AVX512;
+
+// Kernel chosen by the CPU features at the first call, $HIST_KERNEL may force
+// one of "scalar", "avx2" or "avx512" (if the CPU supports it)
+const Hist_Kernel &hist_kernel();
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "P5_Image.h"
+
+
+// Remap of every value of an image, max value + 1 entries
+typedef std::vector<std::uint16_t> Image_Lut;
+
+typedef struct {
+    std::vector<std::uint64_t> cdf;     // cdf[v] is the number of samples up to v
+    unsigned int min, max;              // of the samples present, 0 for an empty image
+    double mean;
+    unsigned int otsu_threshold;        // samples up to it are the background
+    Image_Lut equalization;             // spreads the values evenly over 0..max value
+} Hist_Stats;
+
+// Statistics derived from the histogram in O(bins), the pixels are not read again
+Hist_Stats histogram_stats(const Image_Hist &hist);
+
+// Image remapped by the table, the rows of the result are contiguous. 8-bit
+// images are remapped by a SIMD kernel (see lut_simd.h), 16-bit ones by a scalar loop
+std::vector<std::uint8_t> apply_lut(Image_View img, Image_Lut lut);
+std::vector<std::uint8_t> apply_lut_no_omp(Image_View img, Image_Lut lut);
@@ -0,0 +1,41 @@
+#pragma once
+#include <map>
+#include <string_view>
+#include "P5_Image.h"
+
+
+typedef Image_Hist (*histogram_t)(Image_View);
+
+typedef struct {
+    histogram_t omp;
+    histogram_t no_omp;
+    bool wide;          // counts 16-bit samples as well
+} Engine;
+
+// Histogram engines by name, "auto" is not among them (see select_engine)
+extern const std::map<std::string_view, Engine> engines;
+
+// Name of the engine expected to be the fastest for the view and the team size
+std::string_view select_engine(const Image_View &img, int threads);
+
+
+// Private table per thread, the tables are merged in parallel
+Image_Hist compute_histogram(Image_View img);
+Image_Hist compute_histogram_no_omp(Image_View img);
+
+// Private tables of interleaved sub-histograms counted by a SIMD kernel, 8-bit only
+Image_Hist compute_histogram_simd(Image_View img);
+Image_Hist compute_histogram_simd_no_omp(Image_View img);
+
+// Single table shared by the team, incremented atomically
+Image_Hist compute_histogram_atomic(Image_View img);
+
+// Samples are bucketed by the high byte, then every bucket is counted by a single thread
+Image_Hist compute_histogram_radix(Image_View img);
+
+
+// Color pixels are counted in one pass by a private table per thread, which holds the
+// tables of R, G, B and of the luma (when asked for) one after another. The result
+// is the histograms of the channels in the same order, max value + 1 bins each
+Image_Hist compute_color_histogram(Image_View img, bool luma);
+Image_Hist compute_color_histogram_no_omp(Image_View img, bool luma);
@@ -0,0 +1,102 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <omp.h>
+#include "P5_Image.h"
+#include "hist_arena.h"
+#include "omp_estimator.h"
+
+
+typedef struct {
+    unsigned int tiles_x, tiles_y;
+    unsigned int bins;
+    Image_Hist hists;           // bins per tile, the tiles row by row
+} Tile_Hists;
+
+// Histograms of the tiles of tile_width x tile_height pixels (the tiles of the
+// last column and row are cut by the image), the tiles are shared by the team
+Tile_Hists tile_histograms(Image_View img, unsigned int tile_width, unsigned int tile_height, bool omp_enable);
+
+// Every pixel replaced by its rank in the window around it (see slide_window):
+// the share of the window not above it, scaled to the max value. 8-bit only
+std::vector<std::uint8_t> local_equalize(Image_View img, unsigned int radius, bool omp_enable);
+
+
+// Calls visit(x, y, window, count) for every pixel of an 8-bit image with the
+// histogram of the window of (2 * radius + 1)^2 pixels around it (cut by the
+// image) and the number of pixels in the window. Every thread takes a band of
+// rows and keeps a histogram per column of the image, which covers the rows of
+// the window. Moving down a row, a column drops a pixel and takes one, moving
+// right, the window takes the entering column and drops the leaving one. So a
+// pixel costs two additions of histograms whatever the radius
+template <class Visitor>
+void slide_window(Image_View img, unsigned int radius, Visitor visit, bool omp_enable) {
+    constexpr std::size_t bins = 256;
+    // Columns of every thread and the window after them
+    Hist_Arena &arena = ::caller_arena();
+    long width = img.width, height = img.height, r = radius;
+
+    arena.reserve(omp_enable ? omp_get_max_threads() : 1, (img.width + 1) * bins);
+
+    #pragma omp parallel if(omp_enable)
+    {
+        int threads = omp_get_num_threads();
+        int thread = omp_get_thread_num();
+        std::uint32_t *columns = arena.claim(thread);
+        std::uint32_t *window = columns + img.width * bins;
+        long first = height * thread / threads;
+        long last = height * (thread + 1) / threads;
+
+        auto pixel = [&img](long x, long y) { return img.data[y * img.stride + x]; };
+
+        // Moves the column c from the rows around y - 1 to the rows around y
+        auto move_down = [&](long c, long y) {
+            if (y - r - 1 >= 0)
+                --columns[c * bins + pixel(c, y - r - 1)];
+            if (y + r < height)
+                ++columns[c * bins + pixel(c, y + r)];
+        };
+
+        // Columns cover the rows around the one above the band
+        for (long y = std::max(first - 1 - r, 0l); y < std::min(first + r, height) && first < last; ++y)
+            for (long c = 0; c < width; ++c)
+                ++columns[c * bins + pixel(c, y)];
+
+        for (long y = first; y < last; ++y) {
+            long rows = std::min(y + r, height - 1) - std::max(y - r, 0l) + 1;
+
+            std::fill(window, window + bins, 0);
+            for (long c = 0; c < std::min(r, width - 1) + 1; ++c) {
+                const std::uint32_t *column = columns + c * bins;
+
+                move_down(c, y);
+                #pragma omp simd
+                for (std::size_t v = 0; v < bins; ++v)
+                    window[v] += column[v];
+            }
+
+            for (long x = 0; x < width; ++x) {
+                if (x > 0 && x + r < width) {
+                    const std::uint32_t *column = columns + (x + r) * bins;
+
+                    move_down(x + r, y);
+                    #pragma omp simd
+                    for (std::size_t v = 0; v < bins; ++v)
+                        window[v] += column[v];
+                }
+
+                if (x - r - 1 >= 0) {
+                    const std::uint32_t *column = columns + (x - r - 1) * bins;
+
+                    #pragma omp simd
+                    for (std::size_t v = 0; v < bins; ++v)
+                        window[v] -= column[v];
+                }
+
+                long cols = std::min(x + r, width - 1) - std::max(x - r, 0l) + 1;
+                visit(x, y, static_cast<const std::uint32_t*>(window), static_cast<std::uint32_t>(rows * cols));
+            }
+        }
+    }
+}
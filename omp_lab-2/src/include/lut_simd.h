@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+
+// Remaps n 8-bit pixels by a table of 256 values: out[i] = lut[data[i]]
+typedef void (*lut_kernel_t)(const std::uint8_t *data, std::size_t n, const std::uint8_t *lut, std::uint8_t *out);
+
+typedef struct {
+    const char *name;
+    lut_kernel_t apply;
+} Lut_Kernel;
+
+extern const Lut_Kernel LUT_KERNEL_SCALAR;
+extern const Lut_Kernel LUT_KERNEL_AVX2;
+extern const Lut_Kernel LUT_KERNEL_AVX512;
+
+// Kernel chosen by the CPU features at the first call, $LUT_KERNEL may force
+// one of "scalar", "avx2" or "avx512" (if the CPU supports it)
+const Lut_Kernel &lut_kernel();
@@ -11,10 +11,15 @@ namespace omp_estimator {
         int num_iterations;
 
         double avg_duration = -1;
+        double avg_stage_duration = 0;
+        double first_duration = -1;
         std::any return_value;
 
-        static std::chrono::_V2::steady_clock::time_point begin;
-        static std::chrono::_V2::steady_clock::time_point end;
+        // Engines may run concurrently (batch mode), each thread keeps its own marks.
+        // A stage is marked by the master of a team, i.e. the calling thread
+        static thread_local std::chrono::_V2::steady_clock::time_point begin;
+        static thread_local std::chrono::_V2::steady_clock::time_point stage;
+        static thread_local std::chrono::_V2::steady_clock::time_point end;
     public:
         PerformanceEstimator(int iterations = 100): num_iterations(iterations) {};
         
@@ -26,9 +31,13 @@ namespace omp_estimator {
         void set_return_value(std::function<void()> &callable) { return; };
 
         double get_elapsed_time();
+        double get_stage_time();
+        // Time of the very first run, which also pays for the page faults of mapped pixels
+        double get_first_time();
         std::any get_return_value();
         
         inline friend void timer_begin();
+        inline friend void timer_stage();
         inline friend void timer_end();
     };
 
@@ -36,10 +45,12 @@ namespace omp_estimator {
     template <class T, class... Args>
     void PerformanceEstimator::estimate(T (*callable)(Args...), Args... args) {
         int64_t execution_time = 0;
+        int64_t stage_time = 0;
         
         // Standardizing callable
         std::function<T()> func = std::bind(callable, std::forward<Args>(args)...);
         set_return_value(func);
+        this->first_duration = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()) / 1000000;
         
         // Warming up
         for (int i = 0; i < num_iterations / 10; i++) {
@@ -50,10 +61,14 @@ namespace omp_estimator {
         for (int i = 0; i < num_iterations; i++) {
             func();
             execution_time += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+
+            if (stage > begin)
+                stage_time += std::chrono::duration_cast<std::chrono::nanoseconds>(end - stage).count();
         }
 
         // Averaging and conversion from nanosec to millisec
         this->avg_duration = static_cast<double>(execution_time) / num_iterations / 1000000;
+        this->avg_stage_duration = static_cast<double>(stage_time) / num_iterations / 1000000;
     };
     
     
@@ -65,6 +80,13 @@ namespace omp_estimator {
 
     inline void timer_begin() {
         omp_estimator::PerformanceEstimator::begin = std::chrono::_V2::steady_clock::now();
+        omp_estimator::PerformanceEstimator::stage = std::chrono::_V2::steady_clock::time_point::min();
+    }
+
+    // Marks the beginning of the last stage of the measured code (e.g. a merge
+    // of partial results), its time is averaged separately
+    inline void timer_stage() {
+        omp_estimator::PerformanceEstimator::stage = std::chrono::_V2::steady_clock::now();
     }
 
     inline void timer_end() {
@@ -1,6 +1,8 @@
 #pragma once
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <vector>
 
 
 template <class T>
@@ -0,0 +1,74 @@
+// Build options (see src/hist_ocl.cpp):
+//   SAMPLE_SIZE  bytes per sample, 1 or 2 (the most significant byte first)
+//   BINS         max value + 1, and a bin for the samples above it with SAMPLE_SIZE 2
+//   COPIES       sub-tables of a work-group in the local memory
+//   LOCAL_TABLE  1 when BINS * COPIES counters fit into the local memory, 0 otherwise
+
+
+// Bin of the sample, 16-bit samples above the max value go to the last one
+uint sampleAt(const __global uchar* data, uint i) {
+#if SAMPLE_SIZE == 1
+	return data[i];
+#else
+	return min((uint)data[2 * i] << 8 | data[2 * i + 1], (uint)BINS - 1);
+#endif
+}
+
+
+
+// Every work-group counts its share of the samples into a partial histogram of its
+// own, partials[group][BINS]. Work-items take the samples by the global size
+// apart, so the neighbouring items read the neighbouring samples
+__kernel void
+countHistogram(const __global uchar* data, const uint size, __global uint* partials) {
+	const uint lid = get_local_id(0);
+	__global uint* partial = partials + get_group_id(0) * BINS;
+
+#if LOCAL_TABLE
+	// Neighbouring work-items increment different sub-tables, so a run of the same
+	// value (e.g. a flat area) does not serialize all the atomics on a single counter
+	__local uint table[BINS * COPIES];
+	const uint copy = (lid % COPIES) * BINS;
+
+	for (uint b = lid; b < BINS * COPIES; b += get_local_size(0))
+		table[b] = 0;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint i = get_global_id(0); i < size; i += get_global_size(0))
+		atomic_inc(&table[copy + sampleAt(data, i)]);
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	// The sub-tables are summed into the partial histogram of the group
+	for (uint b = lid; b < BINS; b += get_local_size(0)) {
+		uint sum = 0;
+		for (uint c = 0; c < COPIES; ++c)
+			sum += table[c * BINS + b];
+		partial[b] = sum;
+	}
+#else
+	// The table does not fit into the local memory (16-bit samples), the group
+	// counts straight into its partial histogram by the global atomics
+	for (uint b = lid; b < BINS; b += get_local_size(0))
+		partial[b] = 0;
+	barrier(CLK_GLOBAL_MEM_FENCE);
+
+	for (uint i = get_global_id(0); i < size; i += get_global_size(0))
+		atomic_inc(&partial[sampleAt(data, i)]);
+#endif
+}
+
+
+
+// Sums the partial histograms of all the groups, a work-item per bin
+__kernel void
+mergeHistogram(const __global uint* partials, const uint groups, __global uint* hist) {
+	const uint b = get_global_id(0);
+
+	if (b >= BINS)
+		return;
+
+	uint sum = 0;
+	for (uint g = 0; g < groups; ++g)
+		sum += partials[g * BINS + b];
+	hist[b] = sum;
+}
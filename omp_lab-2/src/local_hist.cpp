@@ -0,0 +1,64 @@
+#include "local_hist.h"
+
+
+template <unsigned int depth>
+static void count_tile(std::uint32_t *hist, Image_View img, unsigned int x, unsigned int y,
+                       unsigned int width, unsigned int height) {
+    for (unsigned int row = y; row < y + height; ++row) {
+        const std::uint8_t *line = img.data + row * img.stride;
+
+        for (unsigned int i = x; i < x + width; ++i)
+            ++hist[sample_value<depth>(line, i)];
+    }
+}
+
+
+Tile_Hists tile_histograms(Image_View img, unsigned int tile_width, unsigned int tile_height, bool omp_enable) {
+    Tile_Hists tiles;
+
+    tiles.tiles_x = (img.width + tile_width - 1) / tile_width;
+    tiles.tiles_y = (img.height + tile_height - 1) / tile_height;
+    tiles.bins = img.max_val + 1;
+    tiles.hists.assign(static_cast<std::size_t>(tiles.tiles_x) * tiles.tiles_y * tiles.bins, 0);
+
+    std::size_t tiles_num = static_cast<std::size_t>(tiles.tiles_x) * tiles.tiles_y;
+
+    omp_estimator::timer_begin();
+    // Every tile is counted right into its own histogram, no tables to merge
+    #pragma omp parallel for schedule(dynamic) if(omp_enable)
+    for (std::size_t t = 0; t < tiles_num; ++t) {
+        unsigned int x = static_cast<unsigned int>(t % tiles.tiles_x) * tile_width;
+        unsigned int y = static_cast<unsigned int>(t / tiles.tiles_x) * tile_height;
+        unsigned int width = std::min(tile_width, img.width - x);
+        unsigned int height = std::min(tile_height, img.height - y);
+        std::uint32_t *hist = tiles.hists.data() + t * tiles.bins;
+
+        if (sample_size(img.max_val) == 1)
+            ::count_tile<1>(hist, img, x, y, width, height);
+        else
+            ::count_tile<2>(hist, img, x, y, width, height);
+    }
+    omp_estimator::timer_end();
+
+    return tiles;
+}
+
+
+std::vector<std::uint8_t> local_equalize(Image_View img, unsigned int radius, bool omp_enable) {
+    std::vector<std::uint8_t> result(static_cast<std::size_t>(img.width) * img.height);
+
+    omp_estimator::timer_begin();
+    ::slide_window(img, radius, [&](long x, long y, const std::uint32_t *window, std::uint32_t count) {
+        unsigned int value = img.data[y * img.stride + x];
+        std::uint32_t not_above = 0;
+
+        #pragma omp simd reduction(+: not_above)
+        for (unsigned int v = 0; v <= value; ++v)
+            not_above += window[v];
+
+        result[y * img.width + x] = static_cast<std::uint8_t>(static_cast<std::uint64_t>(not_above) * img.max_val / count);
+    }, omp_enable);
+    omp_estimator::timer_end();
+
+    return result;
+}
@@ -0,0 +1,87 @@
+#include <cstdlib>
+#include <string_view>
+#include <immintrin.h>
+#include "lut_simd.h"
+
+
+static void lut_apply_scalar(const std::uint8_t *data, std::size_t n, const std::uint8_t *lut, std::uint8_t *out) {
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = lut[data[i]];
+}
+
+
+// 8 pixels per gather from the table widened to 32 bits, the results are packed back to bytes
+__attribute__((target("avx2")))
+static void lut_apply_avx2(const std::uint8_t *data, std::size_t n, const std::uint8_t *lut, std::uint8_t *out) {
+    alignas(32) int wide[256];
+    std::size_t i = 0;
+
+    for (int v = 0; v < 256; ++v)
+        wide[v] = lut[v];
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i values[4];
+
+        for (int j = 0; j < 4; ++j) {
+            __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data + i + 8 * j)));
+            values[j] = _mm256_i32gather_epi32(wide, index, 4);
+        }
+
+        // Packs work within 128-bit halves, the permute restores the order of the pixels
+        __m256i words = _mm256_packus_epi32(values[0], values[1]);
+        __m256i words_high = _mm256_packus_epi32(values[2], values[3]);
+        __m256i bytes = _mm256_packus_epi16(words, words_high);
+
+        bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), bytes);
+    }
+
+    lut_apply_scalar(data + i, n - i, lut, out + i);
+}
+
+
+// 64 pixels per step: every permute looks up 128 entries of the table by the low
+// 7 bits, the high bit of a pixel selects one of the two results
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+static void lut_apply_avx512(const std::uint8_t *data, std::size_t n, const std::uint8_t *lut, std::uint8_t *out) {
+    const __m512i table_0 = _mm512_loadu_si512(lut);
+    const __m512i table_1 = _mm512_loadu_si512(lut + 64);
+    const __m512i table_2 = _mm512_loadu_si512(lut + 128);
+    const __m512i table_3 = _mm512_loadu_si512(lut + 192);
+    std::size_t i = 0;
+
+    for (; i + 64 <= n; i += 64) {
+        __m512i index = _mm512_loadu_si512(data + i);
+        __m512i low = _mm512_permutex2var_epi8(table_0, index, table_1);
+        __m512i high = _mm512_permutex2var_epi8(table_2, index, table_3);
+
+        _mm512_storeu_si512(out + i, _mm512_mask_blend_epi8(_mm512_movepi8_mask(index), low, high));
+    }
+
+    lut_apply_scalar(data + i, n - i, lut, out + i);
+}
+
+
+const Lut_Kernel LUT_KERNEL_SCALAR = {"scalar", lut_apply_scalar};
+const Lut_Kernel LUT_KERNEL_AVX2 = {"avx2", lut_apply_avx2};
+const Lut_Kernel LUT_KERNEL_AVX512 = {"avx512", lut_apply_avx512};
+
+
+const Lut_Kernel &lut_kernel() {
+    static const Lut_Kernel &kernel = []() -> const Lut_Kernel & {
+        const char *forced = std::getenv("LUT_KERNEL");
+        std::string_view name = forced ? forced : "";
+
+        if (name == "scalar")
+            return LUT_KERNEL_SCALAR;
+        if ((name.empty() || name == "avx512") && __builtin_cpu_supports("avx512vbmi") &&
+            __builtin_cpu_supports("avx512bw"))
+            return LUT_KERNEL_AVX512;
+        if ((name.empty() || name == "avx2") && __builtin_cpu_supports("avx2"))
+            return LUT_KERNEL_AVX2;
+
+        return LUT_KERNEL_SCALAR;
+    }();
+
+    return kernel;
+}
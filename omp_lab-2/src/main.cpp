@@ -1,107 +1,408 @@
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string_view>
 #include <omp.h>
-#include <memory.h>
 
 #include "omp_estimator.h"
 #include "P5_Image.h"
+#include "histogram.h"
+#include "P5_Stream.h"
+#include "P5_Batch.h"
+#include "hist_stats.h"
+#include "local_hist.h"
+#include "hist_sample.h"
 #include "utilities.h"
+#ifdef USE_OPENCL
+#include "hist_ocl.h"
+#endif
 
 
-Image_Hist compute_histogram(P5_Image img) {
-    Image_Hist hist_result(img.max_val + 1, 0);
-
-    omp_estimator::timer_begin();   // Start of the time measurement
-
-    uint8_t* data = img.data.data();
-    auto len = img.max_val + 1;
-    std::size_t remainder = img.data.size() % 4;
-    std::uint32_t hist[len * omp_get_max_threads()];
-    memset(hist, 0, sizeof(std::uint32_t) * len * omp_get_max_threads());
-
-    #pragma omp parallel
-    {
-        unsigned thr_offset = static_cast<unsigned>(len * omp_get_thread_num());
-
-        #pragma omp for schedule(runtime)
-        for (std::size_t i = 0; i < img.data.size() - remainder; i += 4) {
-            ++hist[thr_offset + static_cast<unsigned>(data[i])];
-            ++hist[thr_offset + static_cast<unsigned>(data[i + 1])];
-            ++hist[thr_offset + static_cast<unsigned>(data[i + 2])];
-            ++hist[thr_offset + static_cast<unsigned>(data[i + 3])];
-        }
-    }
+int main(int argc, char* argv[]) {
+    if (argc < 4)
+        ::report_failure("Invalid number of arguments\n");
 
-    switch (remainder) {
-        case 3: ++hist[data[img.data.size() - 3]];
-        case 2: ++hist[data[img.data.size() - 2]];
-        case 1: ++hist[data[img.data.size() - 1]];
+    bool omp_enable_flag = true;
+    int thr_num = std::atoi(argv[3]);
+    
+    if (thr_num < -1)
+        ::report_failure("Invalid number of threads\n");
+    
+    switch (thr_num) {
+        case -1: omp_enable_flag = false; break;
         case 0: break;
+        default: omp_set_num_threads(thr_num); break;
     }
     
-    remainder = hist_result.size() % 4;
-    for (int thr = 0; thr < omp_get_max_threads(); ++thr) {
-        std::size_t thr_offset = thr * len;
-        
-        for (std::size_t i = 0; i < hist_result.size() - remainder; i += 4) {
-            hist_result[i] += hist[thr_offset + i];
-            hist_result[i + 1] += hist[thr_offset + i + 1];
-            hist_result[i + 2] += hist[thr_offset + i + 2];
-            hist_result[i + 3] += hist[thr_offset + i + 3];
+    // Optional words are a region "x,y,w,h", an engine name, "stream[=<chunk size>]",
+    // "frames[=<fps>]", "batch", "stats", "equalize=<file>", "tiles=<w>x<h>",
+    // "window=<radius>", "delta[=<dirty list>]", "sample=<fraction>", "error=<bound>" and "luma", in any order
+    const char *region = nullptr;
+    std::string_view engine_name = "auto";
+    std::size_t stream_chunk_size = 0;
+    bool frames_flag = false;
+    bool delta_flag = false;
+    const char *dirty_file = nullptr;
+    bool batch_flag = false;
+    bool stats_flag = false;
+    const char *equalize_file = nullptr;
+    unsigned int tile_width = 0, tile_height = 0;
+    bool window_flag = false;
+    unsigned int window_radius = 0;
+    double frames_fps = 0;
+    double sampled_fraction = 0;
+    double sampled_error = 0;
+    bool luma_flag = false;
+
+    for (int i = 4; i < argc; i++) {
+        std::string_view word = argv[i];
+
+        if (word.find(',') != std::string_view::npos)
+            region = argv[i];
+        else if (word == "stream")
+            stream_chunk_size = STREAM_CHUNK_SIZE;
+        else if (word.substr(0, 7) == "stream=") {
+            if (std::sscanf(argv[i] + 7, "%zu", &stream_chunk_size) != 1 || stream_chunk_size == 0)
+                ::report_failure("Invalid chunk size");
+        }
+        else if (word == "batch")
+            batch_flag = true;
+        else if (word == "stats")
+            stats_flag = true;
+        else if (word.substr(0, 9) == "equalize=" && word.size() > 9)
+            equalize_file = argv[i] + 9;
+        else if (word.substr(0, 6) == "tiles=") {
+            char tail;
+            if (std::sscanf(argv[i] + 6, "%ux%u%c", &tile_width, &tile_height, &tail) != 2 ||
+                tile_width == 0 || tile_height == 0)
+                ::report_failure("Invalid tile size");
+        }
+        else if (word.substr(0, 7) == "window=") {
+            char tail;
+            window_flag = true;
+            if (std::sscanf(argv[i] + 7, "%u%c", &window_radius, &tail) != 1)
+                ::report_failure("Invalid window radius");
         }
-        
-        switch (remainder) {
-            case 3: hist_result[hist_result.size() - 3] += hist[thr_offset + hist_result.size() - 3];
-            case 2: hist_result[hist_result.size() - 2] += hist[thr_offset + hist_result.size() - 2];
-            case 1: hist_result[hist_result.size() - 1] += hist[thr_offset + hist_result.size() - 1];
-            case 0: break;
+        else if (word == "delta")
+            delta_flag = true;
+        else if (word.substr(0, 6) == "delta=" && word.size() > 6) {
+            delta_flag = true;
+            dirty_file = argv[i] + 6;
         }
+        else if (word == "luma")
+            luma_flag = true;
+        else if (word.substr(0, 7) == "sample=") {
+            if (std::sscanf(argv[i] + 7, "%lf", &sampled_fraction) != 1 || !(sampled_fraction > 0 && sampled_fraction <= 1))
+                ::report_failure("Invalid sample fraction");
+        }
+        else if (word.substr(0, 6) == "error=") {
+            if (std::sscanf(argv[i] + 6, "%lf", &sampled_error) != 1 || !(sampled_error > 0 && sampled_error < 1))
+                ::report_failure("Invalid error bound");
+        }
+        else if (word == "frames")
+            frames_flag = true;
+        else if (word.substr(0, 7) == "frames=") {
+            frames_flag = true;
+            if (std::sscanf(argv[i] + 7, "%lf", &frames_fps) != 1 || !(frames_fps > 0))
+                ::report_failure("Invalid frame rate");
+        }
+#ifdef USE_OPENCL
+        else if (word == "opencl")
+            engine_name = argv[i];
+#endif
+        else if (engines.count(argv[i]) || std::string_view(argv[i]) == "auto")
+            engine_name = argv[i];
+        else
+            ::report_failure("Unknown histogram engine");
     }
 
-    omp_estimator::timer_end();     // End of the time measurement
+    if (luma_flag && (stream_chunk_size || frames_flag || batch_flag))
+        ::report_failure("Luma is computed for color images only");
 
-    return hist_result;
-}
+    if (delta_flag && !frames_flag)
+        ::report_failure("Delta updates are supported by frames only");
 
+    if ((stats_flag || equalize_file) && (stream_chunk_size || frames_flag || batch_flag))
+        ::report_failure("Statistics are supported for a loaded image only");
 
-Image_Hist compute_histogram_no_omp(P5_Image img) {
-    Image_Hist hist_result(img.max_val + 1, 0);
-    
-    omp_estimator::timer_begin();
-    for (size_t i = 0; i < img.data.size(); ++i) {
-        hist_result[img.data[i]]++;
+    bool local_flag = tile_width || window_flag;
+
+    if (local_flag && (stream_chunk_size || frames_flag || batch_flag || stats_flag || equalize_file ||
+                       (tile_width && window_flag)))
+        ::report_failure("Local histograms are supported for a loaded image only");
+
+    bool sampled_flag = sampled_fraction > 0 || sampled_error > 0;
+
+    if (sampled_flag && (stream_chunk_size || frames_flag || batch_flag || stats_flag || equalize_file || local_flag ||
+                         (sampled_fraction > 0 && sampled_error > 0)))
+        ::report_failure("Sampling is supported for a loaded image only");
+
+    // The device counts a whole histogram of a loaded image, the rest of the modes run the host engines
+    if (engine_name == "opencl" && (stream_chunk_size || frames_flag || batch_flag || stats_flag || equalize_file ||
+                                    local_flag || sampled_flag))
+        ::report_failure("OpenCL engine counts a loaded image only");
+
+    if (batch_flag) {
+        if (region || stream_chunk_size || frames_flag)
+            ::report_failure("Batch mode takes whole images only");
+
+        Batch_Histograms result = ::batch_histograms(::list_batch(argv[1]), engine_name, omp_enable_flag);
+
+        ::save_batch(argv[2], result);
+        std::cout << "Engine: " << engine_name << '\n';
+        std::cout << "Time (" << thr_num << " thread(s)): " << result.time << " ms\n";
+        std::cout << "Images: " << result.names.size() << '\n';
+        std::cout << "Large images: " << result.large << '\n';
+        // Fixed notation, large rates would be printed with an exponent otherwise
+        std::cout << "Throughput: " << std::fixed << std::setprecision(0)
+                  << 1000 * result.names.size() / result.time << " images/s\n";
+
+        return 0;
     }
-    omp_estimator::timer_end();
 
-    return hist_result;
-}
+    if (frames_flag) {
+        if (region)
+            ::report_failure("Regions are not supported by frames");
 
+        if (stream_chunk_size)
+            ::report_failure("Frames are read whole, chunks are not supported");
 
-int main(int argc, char* argv[]) {
-    if (argc != 4)
-        ::report_failure("Invalid number of arguments\n");
+        std::ofstream fout(argv[2], std::ios_base::binary);
 
-    bool omp_enable_flag = true;
-    int thr_num = std::atoi(argv[3]);
-    
-    if (thr_num < -1)
-        ::report_failure("Invalid number of threads\n");
-    
-    switch (thr_num) {
-        case -1: omp_enable_flag = false; break;
-        case 0: break;
-        default: omp_set_num_threads(thr_num); break;
+        if (!fout.is_open())
+            ::report_failure("Unable to open output file");
+
+        std::vector<std::vector<Image_Rect>> dirty;
+
+        if (dirty_file)
+            dirty = ::read_dirty_list(dirty_file);
+
+        Frame_Stream result = ::stream_frames(argv[1], fout, frames_fps, engine_name, omp_enable_flag, delta_flag, dirty);
+
+        std::cout << "Engine: " << result.engine_name << '\n';
+        std::cout << "Time (" << thr_num << " thread(s)): " << result.time << " ms\n";
+        std::cout << "Frames: " << result.frames << '\n';
+        // Fixed notation, then the default one is restored for the latencies
+        std::cout << "Throughput: " << std::fixed << std::setprecision(0)
+                  << 1000 * result.frames / result.time << " frames/s\n" << std::defaultfloat << std::setprecision(6);
+        std::cout << "Latency p50: " << ::latency_percentile(result, 50) << " ms\n";
+        std::cout << "Latency p90: " << ::latency_percentile(result, 90) << " ms\n";
+        std::cout << "Latency p99: " << ::latency_percentile(result, 99) << " ms\n";
+        std::cout << "Latency max: " << ::latency_percentile(result, 100) << " ms\n";
+        if (frames_fps > 0)
+            std::cout << "Missed deadlines: " << result.missed << '\n';
+        if (delta_flag)
+            std::cout << "Changed share: "
+                      << (result.updated_pixels ? 100.0 * result.changed_pixels / result.updated_pixels : 0) << " %\n";
+
+        return 0;
     }
-    
-    auto func = omp_enable_flag ? compute_histogram : compute_histogram_no_omp;
+
+    if (stream_chunk_size) {
+        if (region)
+            ::report_failure("Regions are not supported by streaming");
+
+        Stream_Histogram result = ::stream_histogram(argv[1], stream_chunk_size, engine_name, omp_enable_flag);
+
+        save_histogram(argv[2], result.hist);
+        std::cout << "Engine: " << result.engine_name << '\n';
+        std::cout << "Time (" << thr_num << " thread(s)): " << result.time << " ms\n";
+        std::cout << "Wait time: " << result.wait_time << " ms\n";
+        std::cout << "Chunks: " << result.chunks << '\n';
+        std::cout << "Buffer size: " << result.buffer_size << " bytes\n";
+
+        return 0;
+    }
+
+    auto load_begin = std::chrono::steady_clock::now();
     auto img = read_P5_image_from_file(argv[1]);
+    auto load_end = std::chrono::steady_clock::now();
+    double load_time = std::chrono::duration<double, std::milli>(load_end - load_begin).count();
+
+    // The histogram engines check 16-bit samples against the max value while counting
+    // them, color pixels and tiles are counted by passes of their own, which do not
+    if (sample_size(img.max_val) > 1 && (img.channels > 1 || tile_width) &&
+        !samples_within(img.data, static_cast<std::size_t>(img.width) * img.height * img.channels, img.max_val))
+        ::report_failure("Invalid file format");
+
+    // Engines take a view, so neither the runs nor the measurement copy the pixels
+    Image_View view = image_view(img);
+
+    if (region) {
+        unsigned int x, y, width, height;
+
+        if (std::sscanf(region, "%u,%u,%u,%u", &x, &y, &width, &height) != 4)
+            ::report_failure("Invalid region");
+
+        if (x + static_cast<std::size_t>(width) > view.width || y + static_cast<std::size_t>(height) > view.height)
+            ::report_failure("Region is out of the image");
+
+        view = image_view(view, x, y, width, height);
+    }
+
+    if (luma_flag && view.channels == 1)
+        ::report_failure("Luma is computed for color images only");
+
+    if (view.channels > 1) {
+        if (stats_flag || equalize_file || local_flag || sampled_flag)
+            ::report_failure("Color images are supported by the whole histogram only");
+
+        if (engine_name != "auto" && engine_name != "privatized")
+            ::report_failure("Engine does not support color images");
+
+        omp_estimator::PerformanceEstimator est;
+
+        est.estimate(omp_enable_flag ? ::compute_color_histogram : ::compute_color_histogram_no_omp, view, luma_flag);
+
+        // Histograms of R, G, B and of the luma follow each other
+        save_histogram(argv[2], std::any_cast<Image_Hist>(est.get_return_value()));
+        std::cout << "Engine: fused\n";
+        std::cout << "Channels: " << (luma_flag ? "R,G,B,Y" : "R,G,B") << '\n';
+        std::cout << "Time (" << thr_num << " thread(s)): " << est.get_elapsed_time() << " ms\n";
+        std::cout << "Merge time: " << est.get_stage_time() << " ms\n";
+        std::cout << "Load time: " << load_time << " ms\n";
+        std::cout << "Total time: " << load_time + est.get_elapsed_time() << " ms\n";
+
+        return 0;
+    }
+
+    if (sampled_flag) {
+        if (engine_name != "auto" && !engines.at(engine_name).wide && sample_size(view.max_val) > 1)
+            ::report_failure("Engine does not support 16-bit images");
+
+        if (sampled_error > 0)
+            sampled_fraction = ::sample_fraction(view, sampled_error);
+
+        // Replicates are counted by the engines, which reset the timer, so the runs are timed here
+        constexpr int sample_runs = 10;
+        Sampled_Hist result;
+        auto sample_begin = std::chrono::steady_clock::now();
+
+        for (int run = 0; run < sample_runs; ++run)
+            result = ::sample_histogram(view, sampled_fraction, engine_name, omp_enable_flag);
+
+        double sample_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sample_begin).count() / sample_runs;
+        double pixels = static_cast<double>(view.width) * view.height;
+
+        // The estimates are followed by the bounds
+        Image_Hist output = result.hist;
+        output.insert(output.end(), result.bounds.begin(), result.bounds.end());
+        save_histogram(argv[2], output);
+
+        std::cout << "Engine: " << result.engine_name << '\n';
+        std::cout << "Time (" << thr_num << " thread(s)): " << sample_time << " ms\n";
+        std::cout << "Sampled rows: " << 100 * result.fraction << " %\n";
+        std::cout << "Max bound: "
+                  << (pixels > 0 ? 100 * *std::max_element(result.bounds.begin(), result.bounds.end()) / pixels : 0) << " %\n";
+        std::cout << "Load time: " << load_time << " ms\n";
+
+        return 0;
+    }
+
+    if (tile_width) {
+        omp_estimator::PerformanceEstimator est;
+
+        est.estimate(::tile_histograms, view, tile_width, tile_height, omp_enable_flag);
+        auto tiles = std::any_cast<Tile_Hists>(est.get_return_value());
+
+        // Tiles across, tiles down and bins per tile precede the histograms
+        Image_Hist output = {tiles.tiles_x, tiles.tiles_y, tiles.bins};
+        output.insert(output.end(), tiles.hists.begin(), tiles.hists.end());
+        save_histogram(argv[2], output);
+
+        std::cout << "Tiles: " << tiles.tiles_x << 'x' << tiles.tiles_y << '\n';
+        std::cout << "Time (" << thr_num << " thread(s)): " << est.get_elapsed_time() << " ms\n";
+        std::cout << "Load time: " << load_time << " ms\n";
+
+        return 0;
+    }
+
+    if (window_flag) {
+        if (sample_size(view.max_val) > 1)
+            ::report_failure("Sliding windows support 8-bit images only");
+
+        // A pass takes far longer than a global histogram, so fewer runs are averaged
+        omp_estimator::PerformanceEstimator est(10);
+
+        est.estimate(::local_equalize, view, window_radius, omp_enable_flag);
+        write_P5_image_to_file(argv[2], std::any_cast<std::vector<std::uint8_t>>(est.get_return_value()),
+                               view.width, view.height, view.max_val);
+
+        std::cout << "Window: " << 2 * window_radius + 1 << 'x' << 2 * window_radius + 1 << '\n';
+        std::cout << "Time (" << thr_num << " thread(s)): " << est.get_elapsed_time() << " ms\n";
+        std::cout << "Time per pixel: " << 1e6 * est.get_elapsed_time() / (static_cast<double>(view.width) * view.height) << " ns\n";
+        std::cout << "Load time: " << load_time << " ms\n";
+
+        return 0;
+    }
+
+#ifdef USE_OPENCL
+    if (engine_name == "opencl") {
+        Ocl_Histogram result = ::compute_histogram_ocl(view);
+
+        // Kernels are timed by the profiling events of the device, the number of threads is not used
+        save_histogram(argv[2], result.hist);
+        std::cout << "Engine: opencl\n";
+        std::cout << "Device: " << result.device_name << '\n';
+        std::cout << "Time (" << thr_num << " thread(s)): " << result.kernel_time << " ms\n";
+        std::cout << "Transfer time: " << result.total_time - result.kernel_time << " ms\n";
+        std::cout << "Load time: " << load_time << " ms\n";
+        std::cout << "Total time: " << load_time + result.total_time << " ms\n";
+
+        return 0;
+    }
+#endif
+
+    if (engine_name == "auto")
+        engine_name = ::select_engine(view, omp_enable_flag ? omp_get_max_threads() : 1);
+
+    const Engine &engine = engines.at(engine_name);
+    auto func = omp_enable_flag ? engine.omp : engine.no_omp;
+
+    if (!engine.wide && sample_size(view.max_val) > 1)
+        ::report_failure("Engine does not support 16-bit images");
+
     omp_estimator::PerformanceEstimator est;
 
-    est.estimate(func, img);
+    est.estimate(func, view);
     auto ret = std::any_cast<Image_Hist>(est.get_return_value());
     
     save_histogram(argv[2], ret);
+    std::cout << "Engine: " << engine_name << '\n';
     std::cout << "Time (" << thr_num << " thread(s)): "
                   << est.get_elapsed_time() << " ms\n";
+    std::cout << "Merge time: " << est.get_stage_time() << " ms\n";
+    std::cout << "Merge share: " << 100 * est.get_stage_time() / est.get_elapsed_time() << " %\n";
+    std::cout << "Load time: " << load_time << " ms\n";
+    // Pages of a mapped file are read by the first pass over them
+    std::cout << "First histogram time: " << load_time + est.get_first_time() << " ms\n";
+    std::cout << "Total time: " << load_time + est.get_elapsed_time() << " ms\n";
+
+    if (!stats_flag && !equalize_file)
+        return 0;
+
+    // Statistics take the bins only, the remap is the second and last pass over the pixels
+    auto stats_begin = std::chrono::steady_clock::now();
+    Hist_Stats stats = ::histogram_stats(ret);
+    auto stats_end = std::chrono::steady_clock::now();
+
+    std::cout << "Min: " << stats.min << '\n';
+    std::cout << "Max: " << stats.max << '\n';
+    std::cout << "Mean: " << stats.mean << '\n';
+    std::cout << "Otsu threshold: " << stats.otsu_threshold << '\n';
+    std::cout << "Stats time: " << std::chrono::duration<double, std::milli>(stats_end - stats_begin).count() << " ms\n";
+
+    if (equalize_file) {
+        omp_estimator::PerformanceEstimator lut_est;
+
+        lut_est.estimate(omp_enable_flag ? ::apply_lut : ::apply_lut_no_omp, view, stats.equalization);
+        write_P5_image_to_file(equalize_file, std::any_cast<std::vector<std::uint8_t>>(lut_est.get_return_value()),
+                               view.width, view.height, view.max_val);
+        std::cout << "Equalize time: " << lut_est.get_elapsed_time() << " ms\n";
+    }
 
     return 0;
 }
\ No newline at end of file
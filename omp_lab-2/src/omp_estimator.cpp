@@ -3,14 +3,23 @@
 
 namespace omp_estimator {
 
-    std::chrono::_V2::steady_clock::time_point PerformanceEstimator::begin;
-    std::chrono::_V2::steady_clock::time_point PerformanceEstimator::end;
+    thread_local std::chrono::_V2::steady_clock::time_point PerformanceEstimator::begin;
+    thread_local std::chrono::_V2::steady_clock::time_point PerformanceEstimator::stage;
+    thread_local std::chrono::_V2::steady_clock::time_point PerformanceEstimator::end;
 
 
     double PerformanceEstimator::get_elapsed_time() {
         return avg_duration;
     };
 
+    double PerformanceEstimator::get_stage_time() {
+        return avg_stage_duration;
+    };
+
+    double PerformanceEstimator::get_first_time() {
+        return first_duration;
+    };
+
     std::any PerformanceEstimator::get_return_value() {
         return return_value;
     }
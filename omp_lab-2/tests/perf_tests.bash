@@ -83,3 +83,344 @@ $EXEC $INPUT_FILE $OUTPUT_FILE 1 1>>$TEST_RESULTS
 # Single Thread, OMP disabled
 echo "[1_thr, no_omp]" >> $TEST_RESULTS
 $EXEC $INPUT_FILE $OUTPUT_FILE -1 1>>$TEST_RESULTS
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_load.txt
+LARGE_FILE=$DATA_FOLDER/large.pgm
+
+
+echo "[ INFO ] evaluating image loading; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# Synthetic 8192x8192 image, 64 MiB of pixels
+if [ ! -f "$LARGE_FILE" ]; then
+    { printf 'P5\n8192 8192\n255\n'; head -c 67108864 /dev/urandom; } > $LARGE_FILE
+fi
+
+# Regular files are memory-mapped
+echo "[lena_mmap]" > $TEST_RESULTS
+$EXEC $DATA_FOLDER/lena.pgm $OUTPUT_FILE 0 1>>$TEST_RESULTS
+
+echo "[large_mmap]" >> $TEST_RESULTS
+$EXEC $LARGE_FILE $OUTPUT_FILE 0 1>>$TEST_RESULTS
+
+# Pipes are read by large blocks
+echo "[lena_pipe]" >> $TEST_RESULTS
+cat $DATA_FOLDER/lena.pgm | $EXEC /dev/stdin $OUTPUT_FILE 0 1>>$TEST_RESULTS
+
+echo "[large_pipe]" >> $TEST_RESULTS
+cat $LARGE_FILE | $EXEC /dev/stdin $OUTPUT_FILE 0 1>>$TEST_RESULTS
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_simd.txt
+CONSTANT_FILE=$DATA_FOLDER/constant.pgm
+
+
+echo "[ INFO ] evaluating histogram kernels; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# Synthetic 4096x4096 image of a single value, the worst case for a single table
+if [ ! -f "$CONSTANT_FILE" ]; then
+    { printf 'P5\n4096 4096\n255\n'; head -c 16777216 /dev/zero | tr '\0' 'M'; } > $CONSTANT_FILE
+fi
+
+> $TEST_RESULTS
+for IMAGE in lena baboon pepper constant; do
+    echo "[${IMAGE}_privatized]" >> $TEST_RESULTS
+    $EXEC $DATA_FOLDER/$IMAGE.pgm $OUTPUT_FILE 0 privatized 1>>$TEST_RESULTS
+
+    for KERNEL in scalar avx2 avx512; do
+        echo "[${IMAGE}_${KERNEL}]" >> $TEST_RESULTS
+        HIST_KERNEL=$KERNEL $EXEC $DATA_FOLDER/$IMAGE.pgm $OUTPUT_FILE 0 simd 1>>$TEST_RESULTS
+    done
+done
+
+
+
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+TEST_RESULTS=$DATA_FOLDER/perf_test_merge.txt
+
+
+echo "[ INFO ] evaluating merge of per-thread tables; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+> $TEST_RESULTS
+for THREADS in 1 2 4 8 16 32 64; do
+    echo "[privatized, ${THREADS}_thr]" >> $TEST_RESULTS
+    $EXEC $INPUT_FILE $OUTPUT_FILE $THREADS privatized 1>>$TEST_RESULTS
+done
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_strategy.txt
+
+
+echo "[ INFO ] evaluating histogram strategies; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# Random 8-bit and 16-bit images of 256x256, 1024x1024 and 4096x4096 pixels
+python3 -c "
+import numpy as np
+rng = np.random.default_rng(16)
+for bits in (8, 16):
+    for side in (256, 1024, 4096):
+        max_val = (1 << bits) - 1
+        pixels = rng.integers(0, max_val + 1, (side, side)).astype('u1' if bits == 8 else '>u2')
+        name = '$DATA_FOLDER/random_%d_%d.pgm' % (bits, side)
+        open(name, 'wb').write(f'P5\\n{side} {side}\\n{max_val}\\n'.encode() + pixels.tobytes())
+"
+
+> $TEST_RESULTS
+for BITS in 8 16; do
+    for SIDE in 256 1024 4096; do
+        for THREADS in 1 16 64; do
+            for ENGINE in privatized atomic radix; do
+                echo "[${BITS}bit_${SIDE}px_${THREADS}thr_${ENGINE}]" >> $TEST_RESULTS
+                $EXEC $DATA_FOLDER/random_${BITS}_${SIDE}.pgm $OUTPUT_FILE $THREADS $ENGINE 1>>$TEST_RESULTS
+            done
+
+            # Engine picked by the selector
+            echo "[${BITS}bit_${SIDE}px_${THREADS}thr_auto]" >> $TEST_RESULTS
+            $EXEC $DATA_FOLDER/random_${BITS}_${SIDE}.pgm $OUTPUT_FILE $THREADS auto 1>>$TEST_RESULTS
+        done
+    done
+done
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_stream.txt
+LARGE_FILE=$DATA_FOLDER/large.pgm
+
+
+echo "[ INFO ] evaluating streaming; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# Whole image in memory for reference
+echo "[large, mmap]" > $TEST_RESULTS
+$EXEC $LARGE_FILE $OUTPUT_FILE 0 1>>$TEST_RESULTS
+
+# Single pass over the file by chunks of various size
+for CHUNK in 65536 1048576 16777216 67108864; do
+    echo "[large, chunk_$CHUNK]" >> $TEST_RESULTS
+    $EXEC $LARGE_FILE $OUTPUT_FILE 0 stream=$CHUNK 1>>$TEST_RESULTS
+done
+
+# 2 GiB image generated on the fly, the address space is limited to 512 MB
+echo "[2gib_pipe]" >> $TEST_RESULTS
+(ulimit -v 512000; { printf 'P5\n65536 32768\n255\n'; head -c 2147483648 /dev/zero; } | \
+    $EXEC /dev/stdin $OUTPUT_FILE 0 stream 1>>$TEST_RESULTS)
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_frames.txt
+FRAMES_FILE=$DATA_FOLDER/frames_720p.pgm
+
+
+echo "[ INFO ] evaluating frame streams; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# Camera dump: 120 random 8-bit frames of 1280x720
+python3 -c "
+import numpy as np
+rng = np.random.default_rng(18)
+with open('$FRAMES_FILE', 'wb') as file:
+    for frame in range(120):
+        file.write(b'P5\\n1280 720\\n255\\n' + rng.integers(0, 256, (720, 1280), dtype='u1').tobytes())
+"
+
+# As fast as possible, then replayed at 30, 60 and 240 frames per second
+> $TEST_RESULTS
+for FPS in 0 30 60 240; do
+    for THREADS in 1 4 0; do
+        echo "[frames, fps_${FPS}_threads_${THREADS}]" >> $TEST_RESULTS
+        if [ "$FPS" -eq 0 ]; then
+            $EXEC $FRAMES_FILE $OUTPUT_FILE $THREADS frames 1>>$TEST_RESULTS
+        else
+            $EXEC $FRAMES_FILE $OUTPUT_FILE $THREADS frames=$FPS 1>>$TEST_RESULTS
+        fi
+    done
+done
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_batch.txt
+BATCH_FOLDER=$DATA_FOLDER/batch_small
+
+
+echo "[ INFO ] evaluating batches of images; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# Dataset: 2000 random 8-bit images of 64x64 up to 256x256
+mkdir -p $BATCH_FOLDER
+python3 -c "
+import numpy as np
+rng = np.random.default_rng(19)
+for i in range(2000):
+    width, height = rng.integers(64, 257, 2)
+    pixels = rng.integers(0, 256, (height, width), dtype='u1')
+    open('$BATCH_FOLDER/%04d.pgm' % i, 'wb').write(f'P5\\n{width} {height}\\n255\\n'.encode() + pixels.tobytes())
+"
+
+# A process per image, as the dataset used to be handled
+echo "[batch, per_process]" > $TEST_RESULTS
+BEGIN=$(date +%s%N)
+for FILE in $BATCH_FOLDER/*.pgm; do
+    $EXEC $FILE $OUTPUT_FILE 1 1>/dev/null
+done
+END=$(date +%s%N)
+echo "Throughput: $(python3 -c "print('%.0f' % (2000 * 1e9 / ($END - $BEGIN)))") images/s" >> $TEST_RESULTS
+
+# The whole dataset by a single process
+for THREADS in 1 4 0; do
+    echo "[batch, threads_$THREADS]" >> $TEST_RESULTS
+    $EXEC $BATCH_FOLDER $OUTPUT_FILE $THREADS batch 1>>$TEST_RESULTS
+done
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_equalize.txt
+
+
+echo "[ INFO ] evaluating equalization by LUT kernels; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# Random 4096x4096 image of the strategy tests, remapped by every kernel
+> $TEST_RESULTS
+for KERNEL in scalar avx2 avx512; do
+    echo "[random_8_4096, $KERNEL]" >> $TEST_RESULTS
+    LUT_KERNEL=$KERNEL $EXEC $DATA_FOLDER/random_8_4096.pgm $OUTPUT_FILE 0 equalize=$DATA_FOLDER/equalized.pgm 1>>$TEST_RESULTS
+done
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_window.txt
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+
+
+echo "[ INFO ] evaluating sliding windows; $TEST_RESULTS"
+
+# Cost of a pixel from the radius of the window
+> $TEST_RESULTS
+for RADIUS in 1 2 4 8 16 32 64; do
+    echo "[lena, radius_$RADIUS]" >> $TEST_RESULTS
+    $EXEC $INPUT_FILE $DATA_FOLDER/local.pgm 0 window=$RADIUS 1>>$TEST_RESULTS
+done
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_delta.txt
+MOVING_FILE=$DATA_FOLDER/moving_720p.pgm
+
+
+echo "[ INFO ] evaluating delta updates; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# 120 frames of 1280x720, a static background with a box of 64x64 moving over it
+python3 -c "
+import numpy as np
+rng = np.random.default_rng(22)
+background = rng.integers(0, 256, (720, 1280), dtype='u1')
+with open('$MOVING_FILE', 'wb') as file:
+    for i in range(120):
+        frame = background.copy()
+        frame[4 * i:4 * i + 64, 8 * i:8 * i + 64] = rng.integers(0, 256, (64, 64))
+        file.write(b'P5\\n1280 720\\n255\\n' + frame.tobytes())
+"
+
+# Counted anew, then updated by every compare kernel; random frames change every pixel
+> $TEST_RESULTS
+echo "[moving_counted]" >> $TEST_RESULTS
+$EXEC $MOVING_FILE $OUTPUT_FILE 0 frames 1>>$TEST_RESULTS
+for KERNEL in scalar avx2 avx512; do
+    echo "[moving_delta_$KERNEL]" >> $TEST_RESULTS
+    DIFF_KERNEL=$KERNEL $EXEC $MOVING_FILE $OUTPUT_FILE 0 frames delta 1>>$TEST_RESULTS
+done
+echo "[random_counted]" >> $TEST_RESULTS
+$EXEC $DATA_FOLDER/frames_720p.pgm $OUTPUT_FILE 0 frames 1>>$TEST_RESULTS
+echo "[random_delta]" >> $TEST_RESULTS
+$EXEC $DATA_FOLDER/frames_720p.pgm $OUTPUT_FILE 0 frames delta 1>>$TEST_RESULTS
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_sample.txt
+LARGE_FILE=$DATA_FOLDER/large.pgm
+
+
+echo "[ INFO ] evaluating sampled histograms; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# Exact histogram of the synthetic 8192x8192 image against the sampled ones
+echo "[large, exact]" > $TEST_RESULTS
+$EXEC $LARGE_FILE $OUTPUT_FILE 0 1>>$TEST_RESULTS
+for FRACTION in 0.1 0.01 0.001; do
+    echo "[large, sample_$FRACTION]" >> $TEST_RESULTS
+    $EXEC $LARGE_FILE $OUTPUT_FILE 0 sample=$FRACTION 1>>$TEST_RESULTS
+done
+echo "[large, error_0.001]" >> $TEST_RESULTS
+$EXEC $LARGE_FILE $OUTPUT_FILE 0 error=0.001 1>>$TEST_RESULTS
+
+
+
+TEST_RESULTS=$DATA_FOLDER/perf_test_color.txt
+COLOR_FILE=$DATA_FOLDER/color_large.ppm
+
+
+echo "[ INFO ] evaluating color histograms; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# Random 4096x2048 RGB image, a gray image of one of its channels and one of all its bytes
+python3 -c "
+import numpy as np
+rgb = np.random.default_rng(24).integers(0, 256, (2048, 4096, 3), dtype='u1')
+open('$COLOR_FILE', 'wb').write(b'P6\\n4096 2048\\n255\\n' + rgb.tobytes())
+open('$DATA_FOLDER/channel_large.pgm', 'wb').write(b'P5\\n4096 2048\\n255\\n' + rgb[..., 0].tobytes())
+open('$DATA_FOLDER/bytes_large.pgm', 'wb').write(b'P5\\n12288 2048\\n255\\n' + rgb.tobytes())
+"
+
+# A separate pass per channel reads every byte of the image, the fused one reads them once
+echo "[color, one_channel]" > $TEST_RESULTS
+$EXEC $DATA_FOLDER/channel_large.pgm $OUTPUT_FILE 0 privatized 1>>$TEST_RESULTS
+echo "[color, all_bytes]" >> $TEST_RESULTS
+$EXEC $DATA_FOLDER/bytes_large.pgm $OUTPUT_FILE 0 privatized 1>>$TEST_RESULTS
+echo "[color, fused]" >> $TEST_RESULTS
+$EXEC $COLOR_FILE $OUTPUT_FILE 0 1>>$TEST_RESULTS
+echo "[color, fused_luma]" >> $TEST_RESULTS
+$EXEC $COLOR_FILE $OUTPUT_FILE 0 luma 1>>$TEST_RESULTS
+
+
+
+OCL_EXEC=./build/omp_lab2_ocl.elf
+TEST_RESULTS=$DATA_FOLDER/perf_test_opencl.txt
+LARGE_FILE=$DATA_FOLDER/large.pgm
+
+
+echo "[ INFO ] evaluating the OpenCL engine; $TEST_RESULTS"
+
+export OMP_SCHEDULE=static
+
+# The same images by the host engine chosen for all threads and by the default device
+if [ -x "$OCL_EXEC" ] && $OCL_EXEC $DATA_FOLDER/lena.pgm $OUTPUT_FILE 0 opencl > /dev/null 2>&1; then
+    > $TEST_RESULTS
+    for INPUT_FILE in $DATA_FOLDER/lena.pgm $LARGE_FILE; do
+        NAME=$(basename $INPUT_FILE .pgm)
+        echo "[$NAME, ${NAME}_host]" >> $TEST_RESULTS
+        $EXEC $INPUT_FILE $OUTPUT_FILE 0 1>>$TEST_RESULTS
+        echo "[$NAME, ${NAME}_opencl]" >> $TEST_RESULTS
+        $OCL_EXEC $INPUT_FILE $OUTPUT_FILE 0 opencl 1>>$TEST_RESULTS
+    done
+else
+    echo "[ INFO ] $OCL_EXEC is not built (make opencl) or there is no OpenCL device, skipped"
+fi
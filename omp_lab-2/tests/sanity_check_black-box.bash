@@ -84,6 +84,680 @@ assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)
 
 
 
+echo; echo "GROUP: image loading"
+
+# POSITIVE: all threads, image read from a pipe, TC_11
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+cat $INPUT_FILE | $EXEC /dev/stdin $OUTPUT_FILE 0 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)" "True"
+
+# POSITIVE: all threads, load and total time are reported, TC_12
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 | grep -c '^Load time: \|^Total time: ')" "2"
+
+# NEGATIVE: truncated pixel data, TC_13
+head -c 1000 $INPUT_FILE > $DATA_FOLDER/truncated.pgm
+assert "$($EXEC $DATA_FOLDER/truncated.pgm $OUTPUT_FILE 0 2>&1)" "[ ERROR ]: Unexpected end of file"
+
+# NEGATIVE: not a P5 image, TC_14
+printf 'P2\n1 1\n255\n0\n' > $DATA_FOLDER/invalid.pgm
+assert "$($EXEC $DATA_FOLDER/invalid.pgm $OUTPUT_FILE 0 2>&1)" "[ ERROR ]: Invalid file format"
+
+# NEGATIVE: missing file, TC_15
+assert "$($EXEC $DATA_FOLDER/missing.pgm $OUTPUT_FILE 0 2>&1)" "[ ERROR ]: Unable to open input file"
+
+
+
+echo; echo "GROUP: image regions"
+
+# POSITIVE: single thread, no omp, region, TC_16
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE -1 10,20,100,50 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE 10,20,100,50)" "True"
+
+# POSITIVE: all threads, region, TC_17
+INPUT_FILE=$DATA_FOLDER/baboon.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE 0 255,0,257,511 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE 255,0,257,511)" "True"
+
+# POSITIVE: all threads, region of full rows, TC_18
+INPUT_FILE=$DATA_FOLDER/pepper.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE 0 0,100,256,3 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE 0,100,256,3)" "True"
+
+# NEGATIVE: region out of the image, TC_19
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 200,0,100,10 2>&1)" "[ ERROR ]: Region is out of the image"
+
+# NEGATIVE: invalid region, TC_20
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 1,2,3 2>&1)" "[ ERROR ]: Invalid region"
+
+
+
+echo; echo "GROUP: simd engine"
+
+# POSITIVE: all threads, kernel chosen by the CPU, TC_21
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE 0 simd 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)" "True"
+
+# POSITIVE: all threads, scalar kernel, TC_22
+INPUT_FILE=$DATA_FOLDER/baboon.pgm
+HIST_KERNEL=scalar $EXEC $INPUT_FILE $OUTPUT_FILE 0 simd 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)" "True"
+
+# POSITIVE: all threads, avx2 kernel (scalar without avx2), TC_23
+INPUT_FILE=$DATA_FOLDER/pepper.pgm
+HIST_KERNEL=avx2 $EXEC $INPUT_FILE $OUTPUT_FILE 0 simd 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)" "True"
+
+# POSITIVE: single thread, no omp, region, TC_24
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE -1 simd 3,5,101,77 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE 3,5,101,77)" "True"
+
+# POSITIVE: all threads, constant image, every pixel hits the same bin, TC_25
+INPUT_FILE=$DATA_FOLDER/flat.pgm
+{ printf 'P5\n1000 999\n255\n'; head -c 999000 /dev/zero | tr '\0' 'M'; } > $INPUT_FILE
+$EXEC $INPUT_FILE $OUTPUT_FILE 0 simd 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)" "True"
+
+# NEGATIVE: unknown engine, TC_26
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 simt 2>&1)" "[ ERROR ]: Unknown histogram engine"
+
+
+
+echo; echo "GROUP: histogram tables"
+
+# POSITIVE: 16 threads, tables reused by all the runs of the measurement, TC_27
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+rm -f $OUTPUT_FILE
+$EXEC $INPUT_FILE $OUTPUT_FILE 16 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)" "True"
+
+# POSITIVE: 16 threads, simd engine, region, TC_28
+rm -f $OUTPUT_FILE
+$EXEC $INPUT_FILE $OUTPUT_FILE 16 simd 7,9,333,222 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE 7,9,333,222)" "True"
+
+
+# POSITIVE: 16 threads, merge time and its share are reported, TC_29
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 16 | grep -c '^Merge time: \|^Merge share: ')" "2"
+
+
+
+echo; echo "GROUP: 16-bit images"
+
+# Random 12-bit and 16-bit images, samples are big-endian
+python3 -c "
+import numpy as np
+rng = np.random.default_rng(16)
+for name, max_val, w, h in (('wide12', 4095, 777, 999), ('wide16', 65535, 1500, 1000)):
+    pixels = rng.integers(0, max_val + 1, (h, w)).astype('>u2')
+    open('$DATA_FOLDER/' + name + '.pgm', 'wb').write(f'P5\\n{w} {h}\\n{max_val}\\n'.encode() + pixels.tobytes())
+"
+
+# POSITIVE: single thread, no omp, 12-bit, TC_30
+INPUT_FILE=$DATA_FOLDER/wide12.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE -1 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)" "True"
+
+# POSITIVE: 4 threads, privatized, 16-bit, TC_31
+INPUT_FILE=$DATA_FOLDER/wide16.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE 4 privatized 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)" "True"
+
+# POSITIVE: 4 threads, atomic, 16-bit, TC_32
+$EXEC $INPUT_FILE $OUTPUT_FILE 4 atomic 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)" "True"
+
+# POSITIVE: 4 threads, radix, 16-bit region, TC_33
+$EXEC $INPUT_FILE $OUTPUT_FILE 4 radix 5,7,300,400 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE 5,7,300,400)" "True"
+
+# POSITIVE: 3 threads, radix, 8-bit, TC_34
+INPUT_FILE=$DATA_FOLDER/baboon.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE 3 radix 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)" "True"
+
+# POSITIVE: 64 threads, tables outgrow a small region, auto leaves privatized, TC_35
+INPUT_FILE=$DATA_FOLDER/wide16.pgm
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 64 0,0,100,100 | grep -c '^Engine: privatized')" "0"
+
+# NEGATIVE: simd engine on a 16-bit image, TC_36
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 simd 2>&1)" "[ ERROR ]: Engine does not support 16-bit images"
+
+# NEGATIVE: max value out of range, TC_37
+printf 'P5\n1 1\n65536\n\0\0' > $DATA_FOLDER/invalid.pgm
+assert "$($EXEC $DATA_FOLDER/invalid.pgm $OUTPUT_FILE 0 2>&1)" "[ ERROR ]: Invalid max value"
+
+# NEGATIVE: samples above the max value of a 16-bit image, TC_38
+{ printf 'P5\n2 2\n300\n'; printf '\0\1\377\377\0\2\0\3'; } > $DATA_FOLDER/invalid.pgm
+assert "$($EXEC $DATA_FOLDER/invalid.pgm $OUTPUT_FILE -1 2>&1)" "[ ERROR ]: Invalid file format"
+
+# NEGATIVE: samples above the max value of a 16-bit image, every wide engine, 4 threads, TC_39
+assert "$(for ENGINE in privatized atomic radix; do $EXEC $DATA_FOLDER/invalid.pgm $OUTPUT_FILE 4 $ENGINE 2>&1; done)" \
+       "$(printf '[ ERROR ]: Invalid file format\n%.0s' 1 2 3)"
+
+# NEGATIVE: colors and tiles of a 16-bit image above the max value, TC_40
+{ printf 'P6\n2 1\n300\n'; printf '\0\1\0\2\0\3\0\4\377\377\0\5'; } > $DATA_FOLDER/invalid_color.pgm
+assert "$($EXEC $DATA_FOLDER/invalid_color.pgm $OUTPUT_FILE 0 2>&1; $EXEC $DATA_FOLDER/invalid.pgm $OUTPUT_FILE 0 tiles=1x1 2>&1)" \
+       "$(printf '[ ERROR ]: Invalid file format\n%.0s' 1 2)"
+
+# NEGATIVE: sample above the max value among the bins of the last bucket of radix, TC_41
+{ printf 'P5\n2 2\n300\n'; printf '\0\1\1\377\0\2\0\3'; } > $DATA_FOLDER/invalid.pgm
+assert "$($EXEC $DATA_FOLDER/invalid.pgm $OUTPUT_FILE 4 radix 2>&1)" "[ ERROR ]: Invalid file format"
+
+# NEGATIVE: samples above the max value, streamed, TC_42
+assert "$($EXEC $DATA_FOLDER/invalid.pgm $OUTPUT_FILE 0 stream 2>&1)" "[ ERROR ]: Invalid file format"
+
+# NEGATIVE: samples above the max value of an 8-bit frame, TC_43
+{ cat $DATA_FOLDER/lena.pgm; printf 'P5\n2 1\n100\n\1\310'; } > $DATA_FOLDER/invalid.pgm
+assert "$($EXEC $DATA_FOLDER/invalid.pgm $OUTPUT_FILE 0 frames 2>&1)" "[ ERROR ]: Invalid file format"
+
+
+
+echo; echo "GROUP: streaming"
+
+# POSITIVE: 4 threads, chunks of 16 rows, TC_44
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE 4 stream=8192 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)" "True"
+
+# POSITIVE: single thread, no omp, 16-bit image from a pipe, TC_45
+INPUT_FILE=$DATA_FOLDER/wide16.pgm
+cat $INPUT_FILE | $EXEC /dev/stdin $OUTPUT_FILE -1 stream=65536 1> /dev/null
+assert "$(python3 ./tools/build_and_check_histogram.py $INPUT_FILE $OUTPUT_FILE)" "True"
+
+# POSITIVE: 64 MiB image through a pipe within 150 MB of address space, TC_46
+(ulimit -v 150000; { printf 'P5\n8192 8192\n255\n'; head -c 67108864 /dev/zero; } | $EXEC /dev/stdin $OUTPUT_FILE 0 stream=1048576 1> /dev/null)
+assert "$(python3 -c "import numpy as np; print(np.fromfile('$OUTPUT_FILE', np.uint32)[0])")" "67108864"
+
+# NEGATIVE: truncated pixel data, TC_47
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+assert "$(head -c 100000 $INPUT_FILE | $EXEC /dev/stdin $OUTPUT_FILE 0 stream=4096 2>&1)" "[ ERROR ]: Unexpected end of file"
+
+# NEGATIVE: region of a streamed image, TC_48
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 stream 0,0,10,10 2>&1)" "[ ERROR ]: Regions are not supported by streaming"
+
+
+
+echo; echo "GROUP: frames"
+
+# Histograms of the frames are records of the bin count followed by the bins
+check_frames() {
+    python3 -c "
+import sys, numpy as np, cv2 as cv
+out = np.fromfile('$OUTPUT_FILE', np.uint32)
+pos = 0
+for name in sys.argv[1:]:
+    pixels = cv.imread(name, cv.IMREAD_UNCHANGED)
+    bins = int(out[pos]) if pos < out.size else 0
+    if bins == 0 or not (np.bincount(pixels.ravel(), minlength=bins)[:bins] == out[pos + 1:pos + 1 + bins]).all():
+        print(False); sys.exit()
+    pos += 1 + bins
+print(pos == out.size)
+" "$@"
+}
+
+# POSITIVE: 4 threads, frames of different size, TC_49
+cat $DATA_FOLDER/lena.pgm $DATA_FOLDER/baboon.pgm $DATA_FOLDER/pepper.pgm > $DATA_FOLDER/frames.pgm
+$EXEC $DATA_FOLDER/frames.pgm $OUTPUT_FILE 4 frames 1> /dev/null
+assert "$(check_frames $DATA_FOLDER/lena.pgm $DATA_FOLDER/baboon.pgm $DATA_FOLDER/pepper.pgm)" "True"
+
+# POSITIVE: single thread, no omp, 8- and 16-bit frames from a pipe, TC_50
+cat $DATA_FOLDER/lena.pgm $DATA_FOLDER/wide16.pgm $DATA_FOLDER/wide12.pgm | $EXEC /dev/stdin $OUTPUT_FILE -1 frames 1> /dev/null
+assert "$(check_frames $DATA_FOLDER/lena.pgm $DATA_FOLDER/wide16.pgm $DATA_FOLDER/wide12.pgm)" "True"
+
+# POSITIVE: replay at 100 frames per second, TC_51
+$EXEC $DATA_FOLDER/frames.pgm $OUTPUT_FILE 0 frames=100 1> /dev/null
+assert "$(check_frames $DATA_FOLDER/lena.pgm $DATA_FOLDER/baboon.pgm $DATA_FOLDER/pepper.pgm)" "True"
+
+# POSITIVE: every frame is counted, the throughput and the latencies are reported, TC_52
+assert "$($EXEC $DATA_FOLDER/frames.pgm $OUTPUT_FILE 0 frames | grep -c '^Frames: 3$\|^Throughput: [0-9]* frames/s$\|^Latency p99: [0-9.]* ms$')" "3"
+
+# NEGATIVE: truncated last frame, TC_53
+assert "$(head -c 550000 $DATA_FOLDER/frames.pgm | $EXEC /dev/stdin $OUTPUT_FILE 0 frames 2>&1)" "[ ERROR ]: Unexpected end of file"
+
+# NEGATIVE: invalid frame rate, TC_54
+assert "$($EXEC $DATA_FOLDER/frames.pgm $OUTPUT_FILE 0 frames=0 2>&1)" "[ ERROR ]: Invalid frame rate"
+
+# NEGATIVE: garbage after the frames, TC_55
+{ cat $DATA_FOLDER/lena.pgm; printf 'P7\n1 1\n255\n\0\0\0'; } > $DATA_FOLDER/invalid.pgm
+assert "$($EXEC $DATA_FOLDER/invalid.pgm $OUTPUT_FILE 0 frames 2>&1)" "[ ERROR ]: Invalid file format"
+
+# NEGATIVE: 16-bit frame by the simd engine while the reader is replaying, TC_56
+cat $DATA_FOLDER/lena.pgm $DATA_FOLDER/wide16.pgm $DATA_FOLDER/lena.pgm $DATA_FOLDER/lena.pgm > $DATA_FOLDER/invalid.pgm
+assert "$($EXEC $DATA_FOLDER/invalid.pgm $OUTPUT_FILE 0 frames=100 simd 2>&1; echo "exit $?")" \
+       "[ ERROR ]: Engine does not support 16-bit images
+exit 1"
+
+
+
+echo; echo "GROUP: batch"
+
+# Index of the output is checked against the names, every histogram against its image
+check_batch() {
+    python3 -c "
+import sys, numpy as np, cv2 as cv
+data = open('$OUTPUT_FILE', 'rb').read()
+count = int(np.frombuffer(data, np.uint32, 1)[0])
+index = np.frombuffer(data, np.dtype([('offset', '<u8'), ('bins', '<u4'), ('name', '<u4')]), count, 4)
+pos = 4 + index.nbytes
+ok = count == len(sys.argv) - 1
+for entry, name in zip(index, sys.argv[1:]):
+    ok = ok and data[pos:pos + entry['name']].decode() == name
+    pos += int(entry['name'])
+    pixels = cv.imread(name, cv.IMREAD_UNCHANGED)
+    hist = np.frombuffer(data, np.uint32, int(entry['bins']), int(entry['offset']))
+    ok = ok and (np.bincount(pixels.ravel(), minlength=hist.size)[:hist.size] == hist).all()
+print(ok and int(index[-1]['offset']) + 4 * int(index[-1]['bins']) == len(data))
+" "$@"
+}
+
+mkdir -p $DATA_FOLDER/batch
+rm -f $DATA_FOLDER/batch/*
+cp $DATA_FOLDER/lena.pgm $DATA_FOLDER/baboon.pgm $DATA_FOLDER/pepper.pgm $DATA_FOLDER/wide16.pgm $DATA_FOLDER/batch/
+touch $DATA_FOLDER/batch/notes.txt
+python3 -c "
+import numpy as np
+pixels = np.random.default_rng(19).integers(0, 256, (2048, 2048), dtype='u1')
+open('$DATA_FOLDER/batch/square.pgm', 'wb').write(b'P5\\n2048 2048\\n255\\n' + pixels.tobytes())
+"
+
+# POSITIVE: directory, 4 threads, the 4 MiB image is counted by the whole team, TC_57
+$EXEC $DATA_FOLDER/batch $OUTPUT_FILE 4 batch 1> /dev/null
+assert "$(check_batch $DATA_FOLDER/batch/baboon.pgm $DATA_FOLDER/batch/lena.pgm $DATA_FOLDER/batch/pepper.pgm \
+                      $DATA_FOLDER/batch/square.pgm $DATA_FOLDER/batch/wide16.pgm)" "True"
+
+# POSITIVE: file list in its own order, single thread, no omp, TC_58
+printf '%s\n' $DATA_FOLDER/pepper.pgm $DATA_FOLDER/wide12.pgm "" $DATA_FOLDER/lena.pgm > $DATA_FOLDER/list.txt
+$EXEC $DATA_FOLDER/list.txt $OUTPUT_FILE -1 batch 1> /dev/null
+assert "$(check_batch $DATA_FOLDER/pepper.pgm $DATA_FOLDER/wide12.pgm $DATA_FOLDER/lena.pgm)" "True"
+
+# POSITIVE: the number of images, of the large ones and the throughput are reported, TC_59
+assert "$($EXEC $DATA_FOLDER/batch $OUTPUT_FILE 0 batch | grep -c '^Images: 5$\|^Large images: 1$\|^Throughput: [0-9]* images/s$')" "3"
+
+# NEGATIVE: missing image of a list, TC_60
+printf '%s\n' $DATA_FOLDER/lena.pgm $DATA_FOLDER/missing.pgm > $DATA_FOLDER/list.txt
+assert "$($EXEC $DATA_FOLDER/list.txt $OUTPUT_FILE 0 batch 2>&1)" "[ ERROR ]: Unable to open input file"
+
+# NEGATIVE: invalid image among the ones counted by the team, 4 threads, TC_61
+printf 'P5\n2 2\n255\n\1' > $DATA_FOLDER/truncated.pgm
+printf '%s\n' $DATA_FOLDER/pepper.pgm $DATA_FOLDER/truncated.pgm $DATA_FOLDER/baboon.pgm $DATA_FOLDER/lena.pgm > $DATA_FOLDER/list.txt
+assert "$($EXEC $DATA_FOLDER/list.txt $OUTPUT_FILE 4 batch 2>&1; echo "exit $?")" "[ ERROR ]: Unexpected end of file
+exit 1"
+
+# NEGATIVE: region of a batch, TC_62
+assert "$($EXEC $DATA_FOLDER/batch $OUTPUT_FILE 0 batch 0,0,10,10 2>&1)" "[ ERROR ]: Batch mode takes whole images only"
+
+
+
+echo; echo "GROUP: statistics"
+
+# Equalized image is compared with the remap of the cropped input by its own cdf
+check_equalized() {
+    python3 -c "
+import sys, numpy as np, cv2 as cv
+x, y, width, height = map(int, sys.argv[3].split(','))
+pixels = cv.imread(sys.argv[1], cv.IMREAD_UNCHANGED)[y:y + height, x:x + width]
+result = cv.imread(sys.argv[2], cv.IMREAD_UNCHANGED)
+max_val = 255 if pixels.dtype == np.uint8 else int(open(sys.argv[1], 'rb').read(64).split()[3])
+cdf = np.cumsum(np.bincount(pixels.ravel(), minlength=max_val + 1)).astype(np.float64)
+cdf_min = cdf[pixels.min()]
+lut = np.floor(np.clip(cdf - cdf_min, 0, None) * max_val / (pixels.size - cdf_min) + 0.5)
+print(result is not None and result.shape == pixels.shape and (result == lut[pixels]).all())
+" "$@"
+}
+
+# POSITIVE: min, max, mean and Otsu threshold, TC_63
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 4 stats | grep '^Min\|^Max\|^Mean\|^Otsu' | tr '\n' ' ')" \
+       "$(python3 -c "
+import cv2 as cv
+pixels = cv.imread('$INPUT_FILE', cv.IMREAD_UNCHANGED)
+otsu = int(cv.threshold(pixels, 0, 255, cv.THRESH_BINARY + cv.THRESH_OTSU)[0])
+print(f'Min: {pixels.min()} Max: {pixels.max()} Mean: {pixels.mean():.6g} Otsu threshold: {otsu} ', end='')
+")"
+
+# POSITIVE: equalized image matches OpenCV with every LUT kernel, TC_64
+equalized=True
+for KERNEL in scalar avx2 avx512; do
+    LUT_KERNEL=$KERNEL $EXEC $INPUT_FILE $OUTPUT_FILE 4 equalize=$DATA_FOLDER/equalized.pgm 1> /dev/null
+    [ "$(python3 -c "
+import cv2 as cv
+print((cv.imread('$DATA_FOLDER/equalized.pgm', cv.IMREAD_UNCHANGED) == cv.equalizeHist(cv.imread('$INPUT_FILE', 0))).all())
+")" == "True" ] || equalized=False
+done
+assert "$equalized" "True"
+
+# POSITIVE: region with a width not divisible by the vectors, no omp, TC_65
+INPUT_FILE=$DATA_FOLDER/baboon.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE -1 13,7,101,37 equalize=$DATA_FOLDER/equalized.pgm 1> /dev/null
+assert "$(check_equalized $INPUT_FILE $DATA_FOLDER/equalized.pgm 13,7,101,37)" "True"
+
+# POSITIVE: 12-bit image, TC_66
+INPUT_FILE=$DATA_FOLDER/wide12.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE 0 equalize=$DATA_FOLDER/equalized.pgm 1> /dev/null
+assert "$(check_equalized $INPUT_FILE $DATA_FOLDER/equalized.pgm 0,0,777,999)" "True"
+
+# POSITIVE: image of a single value is left as it is, TC_67
+printf 'P5\n3 2\n255\n\x07\x07\x07\x07\x07\x07' > $DATA_FOLDER/single.pgm
+$EXEC $DATA_FOLDER/single.pgm $OUTPUT_FILE 0 equalize=$DATA_FOLDER/equalized.pgm 1> /dev/null
+assert "$(cmp $DATA_FOLDER/single.pgm $DATA_FOLDER/equalized.pgm && echo same)" "same"
+
+# POSITIVE: statistics and equalization of a region by a given engine at once, TC_68
+INPUT_FILE=$DATA_FOLDER/baboon.pgm
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 4 stats equalize=$DATA_FOLDER/equalized.pgm 0,0,64,64 privatized | grep -c '^Min\|^Equalize time');\
+$(check_equalized $INPUT_FILE $DATA_FOLDER/equalized.pgm 0,0,64,64)" "2;True"
+
+# NEGATIVE: statistics of a stream, TC_69
+assert "$($EXEC $DATA_FOLDER/lena.pgm $OUTPUT_FILE 0 stream stats 2>&1)" "[ ERROR ]: Statistics are supported for a loaded image only"
+
+
+
+echo; echo "GROUP: local histograms"
+
+# Tile histograms follow the number of tiles across, down and of bins per tile
+check_tiles() {
+    python3 -c "
+import sys, numpy as np, cv2 as cv
+pixels = cv.imread(sys.argv[1], cv.IMREAD_UNCHANGED)
+width, height = map(int, sys.argv[2].split('x'))
+out = np.fromfile('$OUTPUT_FILE', np.uint32)
+tiles_x, tiles_y, bins = map(int, out[:3])
+hists = out[3:].reshape(tiles_y, tiles_x, bins)
+print(tiles_x * width >= pixels.shape[1] > (tiles_x - 1) * width and
+      tiles_y * height >= pixels.shape[0] > (tiles_y - 1) * height and
+      all((np.bincount(pixels[j * height:(j + 1) * height, i * width:(i + 1) * width].ravel(), minlength=bins)[:bins] ==
+           hists[j, i]).all() for j in range(tiles_y) for i in range(tiles_x)))
+" "$@"
+}
+
+# Rank of every pixel of the region in its window, counted by brute force
+check_window() {
+    python3 -c "
+import sys, numpy as np, cv2 as cv
+x, y, width, height = map(int, sys.argv[2].split(','))
+r = int(sys.argv[3])
+pixels = cv.imread(sys.argv[1], cv.IMREAD_UNCHANGED)[y:y + height, x:x + width].astype(np.int64)
+result = cv.imread('$OUTPUT_FILE', cv.IMREAD_UNCHANGED)
+expected = np.zeros_like(pixels)
+for j in range(height):
+    for i in range(width):
+        window = pixels[max(j - r, 0):j + r + 1, max(i - r, 0):i + r + 1]
+        expected[j, i] = (window <= pixels[j, i]).sum() * 255 // window.size
+print(result is not None and (result == expected).all())
+" "$@"
+}
+
+# POSITIVE: tiles cut by the image, 3 threads, TC_70
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE 3 tiles=50x70 1> /dev/null
+assert "$(check_tiles $INPUT_FILE 50x70)" "True"
+
+# POSITIVE: tiles of a 16-bit image, no omp, TC_71
+INPUT_FILE=$DATA_FOLDER/wide12.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE -1 tiles=128x100 1> /dev/null
+assert "$(check_tiles $INPUT_FILE 128x100)" "True"
+
+# POSITIVE: sliding window over a region, 4 threads, TC_72
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE 4 window=3 13,7,101,37 1> /dev/null
+assert "$(check_window $INPUT_FILE 13,7,101,37 3)" "True"
+
+# POSITIVE: window wider than the region, more threads than rows, TC_73
+$EXEC $INPUT_FILE $OUTPUT_FILE 7 window=20 200,100,30,5 1> /dev/null
+assert "$(check_window $INPUT_FILE 200,100,30,5 20)" "True"
+
+# POSITIVE: window of a single pixel leaves every pixel at the max value, TC_74
+$EXEC $INPUT_FILE $OUTPUT_FILE 0 window=0 1> /dev/null
+assert "$(python3 -c "import cv2 as cv; print((cv.imread('$OUTPUT_FILE', cv.IMREAD_UNCHANGED) == 255).all())")" "True"
+
+# NEGATIVE: sliding window over a 16-bit image, TC_75
+assert "$($EXEC $DATA_FOLDER/wide16.pgm $OUTPUT_FILE 0 window=2 2>&1)" "[ ERROR ]: Sliding windows support 8-bit images only"
+
+# NEGATIVE: invalid tile size, TC_76
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 tiles=16x0 2>&1)" "[ ERROR ]: Invalid tile size"
+
+
+
+echo; echo "GROUP: delta updates"
+
+# Frames differ in a moving box, in a single pixel, in the low byte of 16-bit samples and in shape
+python3 -c "
+import numpy as np
+rng = np.random.default_rng(22)
+background = rng.integers(0, 256, (300, 401), dtype='u1')
+with open('$DATA_FOLDER/moving.pgm', 'wb') as file:
+    for i in range(20):
+        frame = background.copy()
+        frame[10 + 5 * i:40 + 5 * i, 20 + 7 * i:77 + 7 * i] = rng.integers(0, 256, (30, 57))
+        frame[299, 400] ^= i == 7
+        file.write(b'P5\\n401 300\\n255\\n' + frame.tobytes())
+    wide = rng.integers(0, 4096, (50, 70)).astype('>u2')
+    for i in range(3):
+        wide[3 * i:3 * i + 4, 5:9] = rng.integers(0, 4096, (4, 4))
+        wide[20, 20 + i] ^= 1
+        file.write(b'P5\\n70 50\\n4095\\n' + wide.tobytes())
+"
+$EXEC $DATA_FOLDER/moving.pgm $DATA_FOLDER/full.bin 0 frames 1> /dev/null
+
+# POSITIVE: updated histograms equal the counted ones with every compare kernel, 4 threads, TC_77
+updated=True
+for KERNEL in scalar avx2 avx512; do
+    DIFF_KERNEL=$KERNEL $EXEC $DATA_FOLDER/moving.pgm $OUTPUT_FILE 4 frames delta 1> /dev/null
+    cmp -s $OUTPUT_FILE $DATA_FOLDER/full.bin || updated=False
+done
+assert "$updated" "True"
+
+# POSITIVE: single thread, no omp, from a pipe, TC_78
+cat $DATA_FOLDER/moving.pgm | $EXEC /dev/stdin $OUTPUT_FILE -1 frames delta 1> /dev/null
+assert "$(cmp -s $OUTPUT_FILE $DATA_FOLDER/full.bin && echo same)" "same"
+
+# POSITIVE: share of the changed pixels of a repeated and of an inverted frame, TC_79
+python3 -c "
+data = open('$DATA_FOLDER/lena.pgm', 'rb').read()
+open('$DATA_FOLDER/inverted.pgm', 'wb').write(data[:15] + bytes(255 - v for v in data[15:]))
+"
+assert "$(cat $DATA_FOLDER/lena.pgm $DATA_FOLDER/lena.pgm | $EXEC /dev/stdin $OUTPUT_FILE 0 frames delta | grep '^Changed share');\
+$(cat $DATA_FOLDER/lena.pgm $DATA_FOLDER/inverted.pgm | $EXEC /dev/stdin $OUTPUT_FILE 0 frames delta | grep '^Changed share')" \
+       "Changed share: 0 %;Changed share: 100 %"
+
+# NEGATIVE: delta updates of a single image, TC_80
+assert "$($EXEC $DATA_FOLDER/lena.pgm $OUTPUT_FILE 0 delta 2>&1)" "[ ERROR ]: Delta updates are supported by frames only"
+
+# Dirty rectangles of the moving box: the boxes of both frames overlap, the changed pixel touches
+# the corners, empty rectangles are added, a new shape is counted anew and the last frame has no line
+python3 -c "
+lines = []
+for i in range(1, 20):
+    rects = ['%d,%d,57,30' % (20 + 7 * j, 10 + 5 * j) for j in (i - 1, i)]
+    rects += ['400,299,1,1', '390,290,20,20'] if i in (7, 8) else ['7,7,0,5', '0,0,3,0']
+    lines.append(' '.join(rects))
+lines += ['0,0,1,1', '5,0,4,10 0,20,70,1 4,2,3,3']
+open('$DATA_FOLDER/dirty.txt', 'w').write('\\n'.join(lines) + '\\n')
+"
+
+# POSITIVE: updates within the dirty rectangles equal the counted histograms, 4 threads and no omp, TC_81
+updated=True
+for THREADS in 4 -1; do
+    $EXEC $DATA_FOLDER/moving.pgm $OUTPUT_FILE $THREADS frames delta=$DATA_FOLDER/dirty.txt 1> /dev/null
+    cmp -s $OUTPUT_FILE $DATA_FOLDER/full.bin || updated=False
+done
+assert "$updated" "True"
+
+# POSITIVE: an empty line and an empty rectangle leave equal frames unchanged, TC_82
+cat $DATA_FOLDER/lena.pgm $DATA_FOLDER/lena.pgm $DATA_FOLDER/lena.pgm > $DATA_FOLDER/frames.pgm
+printf '\n0,0,0,0 600,0,5,5\n' > $DATA_FOLDER/dirty.txt
+assert "$($EXEC $DATA_FOLDER/frames.pgm $OUTPUT_FILE 0 frames delta=$DATA_FOLDER/dirty.txt | grep '^Changed share');\
+$(check_frames $DATA_FOLDER/lena.pgm $DATA_FOLDER/lena.pgm $DATA_FOLDER/lena.pgm)" "Changed share: 0 %;True"
+
+# NEGATIVE: rectangle of three numbers, TC_83
+printf '1,2,3\n' > $DATA_FOLDER/dirty.txt
+assert "$($EXEC $DATA_FOLDER/frames.pgm $OUTPUT_FILE 0 frames delta=$DATA_FOLDER/dirty.txt 2>&1)" "[ ERROR ]: Invalid dirty rectangle"
+
+
+
+echo; echo "GROUP: sampling"
+
+# Share of the bins, which hold the exact count within their bounds (the estimates are followed by the bounds)
+sample_coverage() {
+    python3 -c "
+import sys, numpy as np, cv2 as cv
+pixels = cv.imread(sys.argv[1], cv.IMREAD_UNCHANGED)
+out = np.fromfile('$OUTPUT_FILE', np.uint32).astype(np.int64)
+bins = out.size // 2
+exact = np.bincount(pixels.ravel(), minlength=bins)[:bins]
+print((np.abs(out[:bins] - exact) <= out[bins:]).mean() >= float(sys.argv[2]))
+" "$@"
+}
+
+# POSITIVE: every row sampled gives the exact histogram and zero bounds, TC_84
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE 4 sample=1 1> /dev/null
+assert "$(python3 -c "
+import numpy as np, cv2 as cv
+out = np.fromfile('$OUTPUT_FILE', np.uint32)
+print((out[:256] == np.bincount(cv.imread('$INPUT_FILE', 0).ravel(), minlength=256)).all() and not out[256:].any())
+")" "True"
+
+# POSITIVE: a tenth of the rows, 4 threads, at least 90% of the bins within the bounds, TC_85
+$EXEC $INPUT_FILE $OUTPUT_FILE 4 sample=0.1 1> /dev/null
+assert "$(sample_coverage $INPUT_FILE 0.9)" "True"
+
+# POSITIVE: 16-bit image, no omp, TC_86
+INPUT_FILE=$DATA_FOLDER/wide16.pgm
+$EXEC $INPUT_FILE $OUTPUT_FILE -1 sample=0.05 1> /dev/null
+assert "$(sample_coverage $INPUT_FILE 0.9)" "True"
+
+# POSITIVE: target error of 1% takes less than a tenth of the rows of lena, TC_87
+INPUT_FILE=$DATA_FOLDER/lena.pgm
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 error=0.01 | python3 -c "
+import sys
+rows = [float(line.split()[2]) for line in sys.stdin if line.startswith('Sampled rows')]
+print(len(rows) == 1 and 0 < rows[0] < 10)
+")" "True"
+
+# POSITIVE: a tiny fraction takes a row per replicate at least, TC_88
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 sample=0.0001 | grep '^Sampled rows');$(sample_coverage $INPUT_FILE 0.9)" \
+       "Sampled rows: 3.125 %;True"
+
+# POSITIVE: an image of fewer rows than replicates is counted exactly, TC_89
+printf 'P5\n4 3\n255\n\1\1\2\3\5\10\15\25\40\65\1\2' > $DATA_FOLDER/short.pgm
+$EXEC $DATA_FOLDER/short.pgm $OUTPUT_FILE 0 sample=0.0001 1> /dev/null
+assert "$(sample_coverage $DATA_FOLDER/short.pgm 1)" "True"
+
+# NEGATIVE: fraction out of range, TC_90
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 sample=1.5 2>&1)" "[ ERROR ]: Invalid sample fraction"
+
+# NEGATIVE: sampled stream, TC_91
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 sample=0.1 stream 2>&1)" "[ ERROR ]: Sampling is supported for a loaded image only"
+
+
+
+echo; echo "GROUP: color"
+
+# Checks the histograms of R, G, B (and of the luma) of a P6 image within an optional region "x,y,w,h"
+color_check() {
+    python3 -c "
+import sys, numpy as np
+magic, size, max_val, pixels = open(sys.argv[1], 'rb').read().split(b'\\n', 3)
+width, height = map(int, size.split())
+bins = int(max_val) + 1
+rgb = np.frombuffer(pixels, np.uint8 if bins <= 256 else '>u2')[:width * height * 3].reshape(height, width, 3).astype(np.int64)
+if len(sys.argv) > 3:
+    x, y, w, h = map(int, sys.argv[3].split(','))
+    rgb = rgb[y:y + h, x:x + w]
+channels = [rgb[..., c] for c in range(3)]
+if sys.argv[2] == 'luma':
+    channels.append((77 * rgb[..., 0] + 150 * rgb[..., 1] + 29 * rgb[..., 2] + 128) >> 8)
+expected = np.concatenate([np.bincount(c.ravel(), minlength=bins) for c in channels])
+out = np.fromfile('$OUTPUT_FILE', np.uint32)
+print(out.size == expected.size and (out == expected).all())
+" "$@"
+}
+
+# Color images are made of the test images: lena, baboon and the inverted lena as channels
+python3 -c "
+import numpy as np, cv2 as cv
+lena = cv.imread('$DATA_FOLDER/lena.pgm', 0)
+baboon = cv.resize(cv.imread('$DATA_FOLDER/baboon.pgm', 0), lena.shape[::-1])
+rgb = np.dstack([lena, baboon, 255 - lena])
+open('$DATA_FOLDER/color.ppm', 'wb').write(b'P6\\n%d %d\\n255\\n' % rgb.shape[1::-1] + rgb.tobytes())
+wide = (rgb.astype('>u2') * 257)[:300, :200]
+open('$DATA_FOLDER/color16.ppm', 'wb').write(b'P6\\n200 300\\n65535\\n' + wide.tobytes())
+"
+
+# POSITIVE: R, G and B in one pass, 4 threads, TC_92
+INPUT_FILE=$DATA_FOLDER/color.ppm
+$EXEC $INPUT_FILE $OUTPUT_FILE 4 1> /dev/null
+assert "$(color_check $INPUT_FILE rgb)" "True"
+
+# POSITIVE: luma as the fourth histogram, no omp, TC_93
+$EXEC $INPUT_FILE $OUTPUT_FILE -1 luma 1> /dev/null
+assert "$(color_check $INPUT_FILE luma)" "True"
+
+# POSITIVE: region of a 16-bit image with luma, all threads, TC_94
+INPUT_FILE=$DATA_FOLDER/color16.ppm
+$EXEC $INPUT_FILE $OUTPUT_FILE 0 luma 17,33,150,200 1> /dev/null
+assert "$(color_check $INPUT_FILE luma 17,33,150,200)" "True"
+
+# NEGATIVE: streamed color image, TC_95
+INPUT_FILE=$DATA_FOLDER/color.ppm
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 stream 2>&1)" "[ ERROR ]: Color images are supported by the whole histogram only"
+
+# NEGATIVE: color image by an engine of gray ones, TC_96
+assert "$($EXEC $INPUT_FILE $OUTPUT_FILE 0 simd 2>&1)" "[ ERROR ]: Engine does not support color images"
+
+# NEGATIVE: luma of a gray image, TC_97
+assert "$($EXEC $DATA_FOLDER/lena.pgm $OUTPUT_FILE 0 luma 2>&1)" "[ ERROR ]: Luma is computed for color images only"
+
+
+
+echo; echo "GROUP: opencl"
+
+OCL_EXEC=./build/omp_lab2_ocl.elf
+
+# Histogram of the device against the one of the privatized engine
+ocl_check() {
+    $OCL_EXEC $1 $DATA_FOLDER/full.bin 0 opencl $2 &> /dev/null || rm -f $DATA_FOLDER/full.bin
+    $EXEC $1 $OUTPUT_FILE 4 privatized $2 1> /dev/null
+    cmp -s $OUTPUT_FILE $DATA_FOLDER/full.bin && echo "True" || echo "False"
+}
+
+# The device must be there as well as the build, e.g. PoCL on a host without a GPU
+if [ -x "$OCL_EXEC" ] && $OCL_EXEC $DATA_FOLDER/lena.pgm $OUTPUT_FILE 0 opencl > /dev/null 2>&1; then
+    # POSITIVE: 8-bit image by the local tables, TC_98
+    assert "$(ocl_check $DATA_FOLDER/lena.pgm)" "True"
+
+    # POSITIVE: region of an 8-bit image, packed before the transfer, TC_99
+    assert "$(ocl_check $DATA_FOLDER/baboon.pgm 13,21,200,300)" "True"
+
+    # POSITIVE: flat image, all the samples of a group hit the same counters, TC_100
+    assert "$(ocl_check $DATA_FOLDER/flat.pgm)" "True"
+
+    # POSITIVE: 16-bit image with a small max value, a single local table, TC_101
+    python3 -c "
+import numpy as np
+pixels = np.random.default_rng(25).integers(0, 1001, (700, 900)).astype('>u2')
+open('$DATA_FOLDER/wide10.pgm', 'wb').write(b'P5\\n900 700\\n1000\\n' + pixels.tobytes())
+"
+    assert "$(ocl_check $DATA_FOLDER/wide10.pgm)" "True"
+
+    # POSITIVE: 12-bit and 16-bit images by the global atomics, TC_102
+    assert "$(ocl_check $DATA_FOLDER/wide12.pgm; ocl_check $DATA_FOLDER/wide16.pgm 100,50,1000,900)" "$(printf 'True\nTrue')"
+
+    # NEGATIVE: samples above the max value of a 16-bit image, TC_103
+    { printf 'P5\n2 2\n300\n'; printf '\0\1\377\377\0\2\0\3'; } > $DATA_FOLDER/invalid.pgm
+    assert "$($OCL_EXEC $DATA_FOLDER/invalid.pgm $OUTPUT_FILE 0 opencl 2>&1 1> /dev/null | grep -a '^\[ ERROR \]')" "[ ERROR ]: Invalid file format"
+
+    # NEGATIVE: streamed by the device, TC_104
+    assert "$($OCL_EXEC $DATA_FOLDER/lena.pgm $OUTPUT_FILE 0 opencl stream 2>&1)" "[ ERROR ]: OpenCL engine counts a loaded image only"
+else
+    echo "[ INFO ]: $OCL_EXEC is not built (make opencl) or there is no OpenCL device, skipped"
+fi
+
+
+
 echo; echo "Total tests passed: ${passed} / ${total_counter}"
 
 # Return success or failure if script is sourced
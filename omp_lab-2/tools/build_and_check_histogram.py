@@ -9,11 +9,15 @@ SAVE_FOLDER = 'data'
 def plot_img_hist(colors: np.ndarray, counts: np.ndarray, name: str):
     fig = plt.figure()
     ax = fig.add_subplot(111)
-    ax.bar(colors, counts, width=1.0)
+    # Thousands of bars of a 16-bit histogram take minutes to draw
+    if len(colors) > 256:
+        ax.plot(colors, counts, linewidth=0.5)
+    else:
+        ax.bar(colors, counts, width=1.0)
     ax.set_title(f"PGM histogram for {name}")
     ax.set_xlabel("Color")
     ax.set_ylabel("Quantity")
-    ax.set_xlim([0, 255])
+    ax.set_xlim([0, max(255, colors.max(initial=0))])
     
     plt.savefig(os.path.join(SAVE_FOLDER, 'Hist_from_' + name.split('/')[-1] + '.png'))
 
@@ -21,10 +25,15 @@ def plot_img_hist(colors: np.ndarray, counts: np.ndarray, name: str):
 def main():
     # Read the image and build its histogram
     filename = sys.argv[1]
-    img = cv.imread(filename, 0).flatten()
-    counts = np.zeros(256)
-    for i in img:
-        counts[i] += 1
+    # Samples of 16-bit images are kept as they are
+    img = cv.imread(filename, cv.IMREAD_UNCHANGED)
+    # Optional region of the image in format x,y,width,height
+    if len(sys.argv) > 3:
+        x, y, width, height = [int(i) for i in sys.argv[3].split(',')]
+        img = img[y:y + height, x:x + width]
+    bins = 256 if img.dtype == np.uint8 else 65536
+    img = img.flatten()
+    counts = np.bincount(img, minlength=bins)
     plot_img_hist(np.argwhere(counts != 0).flatten(), counts[counts != 0], filename)
 
     # Read the binary array and compare it to histogram from the above code
@@ -33,7 +42,7 @@ def main():
     else:
         filename = sys.argv[2]
     lst = np.fromfile(filename, np.int32, -1, '')
-    lst.resize(256)
+    lst.resize(bins)
     
     plot_img_hist(np.argwhere(lst != 0).flatten(), lst[lst != 0], filename)
     
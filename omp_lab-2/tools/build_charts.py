@@ -17,10 +17,13 @@ class PlotConfig:
     chart_type: str
     xscale: str = 'linear'
     yscale: str = 'linear'
+    line_prefix: str = 'Time'
+    xrotation: int = 0
+    sections: str = ''
 
 
 
-def parse_file(filename: str):
+def parse_file(filename: str, line_prefix: str):
     data = {}
     lines = []
     section = ''
@@ -33,7 +36,7 @@ def parse_file(filename: str):
             section = line.split('[')[1].split(']')[0]
             data.update({section: []})
         else:
-            if (section == ''):
+            if (section == '' or not line.startswith(line_prefix)):
                 continue
             # NOTE: puts all the floats from current line
             data[section] += [float(i) for i in line.split() if i.replace('.','',1).isdigit()]
@@ -44,7 +47,10 @@ def parse_file(filename: str):
 
 def plot_figure_from_file(plot_conf: PlotConfig):
     print(f'Parsing {plot_conf.filename}')
-    data = parse_file(plot_conf.filename)
+    data = parse_file(plot_conf.filename, plot_conf.line_prefix)
+    # NOTE: keeps only the sections, which names contain the given part
+    if (plot_conf.sections):
+        data = {name: values for name, values in data.items() if plot_conf.sections in name}
 
     if (plot_conf.chart_type == 'chart'):
         plot_chart(data, plot_conf)
@@ -95,6 +101,10 @@ def plot_barchart(data: dict, plot_conf: PlotConfig):
     ax.set_yscale(plot_conf.yscale)
     ax.set_xscale(plot_conf.xscale)
     ax.set_xticks([i for i in range(len(values))], labels=keys)
+    # NOTE: long or numerous labels are tilted, so they do not overlap
+    if (plot_conf.xrotation):
+        plt.setp(ax.get_xticklabels(), rotation=plot_conf.xrotation, ha='right')
+        fig.tight_layout()
 
 
 
@@ -114,6 +124,145 @@ def main():
             xlabel = 'chunk_size',
             ylabel = 'Time (ms)',
             chart_type = 'bar'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_load.txt',
+            fig_name = 'Load time from input source',
+            xlabel = 'input source',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            chart_type = 'bar',
+            line_prefix = 'Load time'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_load.txt',
+            fig_name = 'First histogram time from input source',
+            xlabel = 'input source',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            chart_type = 'bar',
+            line_prefix = 'First histogram time'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_simd.txt',
+            fig_name = 'Performance from histogram kernel',
+            xlabel = 'image, kernel',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            chart_type = 'bar',
+            xrotation = 45
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_merge.txt',
+            fig_name = 'Merge share from number of threads',
+            xlabel = 'Threads',
+            ylabel = 'Merge share (%)',
+            chart_type = 'bar',
+            line_prefix = 'Merge share'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_strategy.txt',
+            fig_name = 'Performance from histogram strategy, 16-bit 256px',
+            xlabel = 'depth, size, threads, engine',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            chart_type = 'bar',
+            xrotation = 45,
+            sections = '16bit_256px'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_strategy.txt',
+            fig_name = 'Performance from histogram strategy, 16-bit 1024px',
+            xlabel = 'depth, size, threads, engine',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            chart_type = 'bar',
+            xrotation = 45,
+            sections = '16bit_1024px'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_stream.txt',
+            fig_name = 'Performance from stream chunk size',
+            xlabel = 'chunk size',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            chart_type = 'bar',
+            xrotation = 45
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_frames.txt',
+            fig_name = 'Throughput from frame rate target',
+            xlabel = 'Target frame rate, threads',
+            ylabel = 'Frames per second',
+            chart_type = 'bar',
+            line_prefix = 'Throughput',
+            xrotation = 45
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_frames.txt',
+            fig_name = 'Latency from frame rate target',
+            xlabel = 'Target frame rate, threads',
+            ylabel = 'p99 latency (ms)',
+            chart_type = 'bar',
+            line_prefix = 'Latency p99',
+            xrotation = 45
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_batch.txt',
+            fig_name = 'Throughput from batch mode',
+            xlabel = 'Mode',
+            ylabel = 'Images per second',
+            yscale = 'log',
+            chart_type = 'bar',
+            line_prefix = 'Throughput'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_equalize.txt',
+            fig_name = 'Equalization from LUT kernel',
+            xlabel = 'LUT kernel',
+            ylabel = 'Time (ms)',
+            chart_type = 'bar',
+            line_prefix = 'Equalize time'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_window.txt',
+            fig_name = 'Performance from window radius',
+            xlabel = 'Radius',
+            ylabel = 'Time per pixel (ns)',
+            chart_type = 'bar',
+            line_prefix = 'Time per pixel'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_delta.txt',
+            fig_name = 'Latency from delta updates',
+            xlabel = 'Frames, histogram',
+            ylabel = 'p50 latency (ms)',
+            chart_type = 'bar',
+            line_prefix = 'Latency p50',
+            xrotation = 45
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_sample.txt',
+            fig_name = 'Performance from sampled fraction',
+            xlabel = 'Sampled fraction',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            chart_type = 'bar'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_color.txt',
+            fig_name = 'Performance from color pass',
+            xlabel = 'Pass',
+            ylabel = 'Time (ms)',
+            chart_type = 'bar'
+        ),
+        PlotConfig(
+            filename = 'data/perf_test_opencl.txt',
+            fig_name = 'Performance from device',
+            xlabel = 'Device',
+            ylabel = 'Time (ms)',
+            yscale = 'log',
+            chart_type = 'bar'
         )
     ]
 